@@ -1,18 +1,23 @@
 #include <Breath_Starlight.h>
+#include "time_sync.h"
+#include "binary_log.h"
+#include "circadian.h"
+#include <limits.h>
 
 //生成实例
 BreathStarlight breathStarlight;
 //构造实例
 BreathStarlight::BreathStarlight()
-    : WARM_WHITE_HUE(30),
-    WARM_WHITE_SATURATION(50),
-    lastStarSpawn(0),
-    STAR_SPAWN_INTERVAL(800), // 每800毫秒尝试生成一个新星
-    WAKE_UP_DURATION(3000),
+    : WAKE_UP_DURATION(3000),
     FADE_OUT_DURATION(2000),
     TARGET_BRIGHTNESS(63),
-    UPDATE_INTERVAL(10), // 更快的更新，使动画更平滑
-    previousMillis(0)
+    wakeUpProgress(WAKE_UP_DURATION),
+    fadeOutProgress(FADE_OUT_DURATION),
+    wakeCurve(CURVE_LINEAR),
+    starCurve(CURVE_LINEAR),
+    fadeOutCurve(CURVE_LINEAR),
+    lastStarSpawn(0),
+    STAR_SPAWN_INTERVAL(800) // 每800毫秒尝试生成一个新星
 {   
 }
 
@@ -20,11 +25,18 @@ void BreathStarlight::begin(CRGB* main, CRGB* ring) {
     mainLeds = main;
     ringLeds = ring;
     initStarSystem();
+    configureNaturalLight();
 }
 
-// 稳定的暖白色调->返回CRGB值
+// 暖白色调->按昼夜节律当前色温和亮度返回CRGB值
 CRGB BreathStarlight::getWarmWhite() {
-  return CHSV(WARM_WHITE_HUE, WARM_WHITE_SATURATION, TARGET_BRIGHTNESS);
+  return circadian.warmWhite(TARGET_BRIGHTNESS);
+}
+
+// 自然光两端色温：在昼夜节律当前色温两侧偏暖/偏冷，峰值为平均亮度的1.25倍
+void BreathStarlight::configureNaturalLight() {
+  uint8_t peak = TARGET_BRIGHTNESS + TARGET_BRIGHTNESS / 4;
+  naturalLight.configure(circadian.warmWhite(peak, -300), circadian.warmWhite(peak, 600));
 }
 
 // 初始化星光系统->将星光点活动性全部设成false
@@ -32,6 +44,7 @@ void BreathStarlight::initStarSystem() {
   for (int i = 0; i < MAX_STARS; i++) {
     stars[i].active = false;
   }
+  lastStarSpawn = ULONG_MAX;  // 还没尝试过任何时间片，时间片0也会尝试
 }
 
 // 获取活跃星光点数->uint8_t
@@ -70,35 +83,39 @@ void BreathStarlight::spawnStar() {
       }
       
       // 随机属性
-      stars[i].hue = WARM_WHITE_HUE + random8(20) - 10; // 暖白色调附近轻微变化
-      stars[i].saturation = 20 + random8(30); // 低饱和度，更接近白色
+      stars[i].kelvinOffset = 300 + random16(900); // 比主灯略冷，更接近白色
       stars[i].brightness = 0;
       stars[i].targetBrightness = 100 + random8(155); // 100-255亮度
-      stars[i].birthTime = millis();
+      stars[i].birthTime = timeSync.now();
       stars[i].lifeDuration = 3000 + random16(7000); // 3-10秒生命周期
-      stars[i].fadeInDuration = 800 + random16(1200); // 0.8-2秒淡入
-      stars[i].fadeOutDuration = 1000 + random16(2000); // 1-3秒淡出
+      stars[i].fadeIn = Progress8(800 + random16(1200)); // 0.8-2秒淡入
+      stars[i].fadeOut = Progress8(1000 + random16(2000)); // 1-3秒淡出
       stars[i].phase = 0; // 淡入阶段
       stars[i].active = true;
       
-      Serial.print("✨ 新生星点 #");
-      Serial.print(i);
-      Serial.print(" 位置:");
-      Serial.print(stars[i].position);
-      Serial.print(" 寿命:");
-      Serial.print(stars[i].lifeDuration);
-      Serial.println("ms");
+      BINLOG(STAR_SPAWN, i, stars[i].position, stars[i].lifeDuration);
       break;
     }
   }
 }
 
+// 时间片序号的整数哈希（murmur3收尾混合），不动FastLED的全局随机种子
+static uint32_t slotHash(uint32_t slot) {
+  slot ^= slot >> 16;
+  slot *= 0x85EBCA6B;
+  slot ^= slot >> 13;
+  slot *= 0xC2B2AE35;
+  slot ^= slot >> 16;
+  return slot;
+}
+
 // 尝试生成新星->按时间带概率生成新星
+// 时间片按同步后的效果时钟对齐，是否生成取决于时间片序号的哈希，同一时间片内结果固定
 void BreathStarlight::trySpawnStar() {
-  unsigned long currentTime = millis();
+  unsigned long slot = timeSync.now() / STAR_SPAWN_INTERVAL;
   
-  if (currentTime - lastStarSpawn > STAR_SPAWN_INTERVAL) {
-    lastStarSpawn = currentTime;
+  if (slot != lastStarSpawn) {
+    lastStarSpawn = slot;
     
     uint8_t activeCount = getActiveStarCount();
     
@@ -108,7 +125,7 @@ void BreathStarlight::trySpawnStar() {
     else if (activeCount < 5) spawnChance = 50; // 中等数量中等概率
     else if (activeCount < 7) spawnChance = 30; // 星多时低概率
     
-    if (random8(100) < spawnChance) {
+    if (slotHash(slot) % 100 < spawnChance) {
       spawnStar();
     }
   }
@@ -116,7 +133,7 @@ void BreathStarlight::trySpawnStar() {
 
 // 更新星光点状态->星点阶段演变
 void BreathStarlight::updateStars() {
-  unsigned long currentTime = millis();
+  unsigned long currentTime = timeSync.now();
   
   for (int i = 0; i < MAX_STARS; i++) {
     if (stars[i].active) {
@@ -131,10 +148,10 @@ void BreathStarlight::updateStars() {
       // 根据阶段更新亮度
       switch (stars[i].phase) {
         case 0: // 淡入阶段
-          if (starAge < stars[i].fadeInDuration) {
-            // 计算淡入进度 (0-255)
-            uint16_t progress = (starAge * 256) / stars[i].fadeInDuration;
-            stars[i].brightness = (stars[i].targetBrightness * progress) / 256;
+          if (starAge < stars[i].fadeIn.getDuration()) {
+            // 淡入进度 (0-255) 经缓动曲线映射为亮度
+            uint8_t progress = stars[i].fadeIn.at(starAge);
+            stars[i].brightness = easeScale(stars[i].targetBrightness, ease8(starCurve, progress));
           } else {
             // 淡入完成，进入稳定阶段
             stars[i].brightness = stars[i].targetBrightness;
@@ -144,16 +161,16 @@ void BreathStarlight::updateStars() {
           
         case 1: // 稳定阶段
           // 保持目标亮度，直到需要开始淡出
-          if (starAge > stars[i].lifeDuration - stars[i].fadeOutDuration) {
+          if (starAge > stars[i].lifeDuration - stars[i].fadeOut.getDuration()) {
             stars[i].phase = 2; // 开始淡出
           }
           break;
           
         case 2: // 淡出阶段
           {
-            unsigned long timeInFadeOut = starAge - (stars[i].lifeDuration - stars[i].fadeOutDuration);
-            uint16_t progress = (timeInFadeOut * 256) / stars[i].fadeOutDuration;
-            stars[i].brightness = stars[i].targetBrightness - ((stars[i].targetBrightness * progress) / 256);
+            unsigned long timeInFadeOut = starAge - (stars[i].lifeDuration - stars[i].fadeOut.getDuration());
+            uint8_t progress = stars[i].fadeOut.at(timeInFadeOut);
+            stars[i].brightness = easeScale(stars[i].targetBrightness, 255 - ease8(starCurve, progress));
           }
           break;
       }
@@ -162,25 +179,23 @@ void BreathStarlight::updateStars() {
 }
 
 // 渲染星光点到环形灯->包含了渲染到灯环操作，不包括FastLED.show()
-void BreathStarlight::renderStars() {
+void BreathStarlight::renderStars(CRGB* ring) {
   // 先清除环形灯
-  fill_solid(ringLeds, Config::RING_NUM_LEDS, CRGB::Black);
+  fill_solid(ring, Config::RING_NUM_LEDS, CRGB::Black);
   
   // 渲染所有活跃的星光点
   for (int i = 0; i < MAX_STARS; i++) {
     if (stars[i].active) {
-      ringLeds[stars[i].position] = CHSV(stars[i].hue, stars[i].saturation, stars[i].brightness);
+      ring[stars[i].position] = circadian.warmWhite(stars[i].brightness, stars[i].kelvinOffset);
     }
   }
   // stableShow();
 }
 
-//FastLED.show()
+//FastLED.show()->交给控制器在帧末统一刷新
 void BreathStarlight::stableShow()
 {
-  delayMicroseconds(50);
-  FastLED.show();
-  delayMicroseconds(50);
+  ledController.requestShow();
 }
 
 // 淡出效果
@@ -203,8 +218,8 @@ bool BreathStarlight::fadeOut() {
     return true;
   }
   
-  uint8_t brightness = startBrightness * (FADE_OUT_DURATION - elapsedTime) / FADE_OUT_DURATION;
-  FastLED.setBrightness(brightness);
+  uint8_t progress = fadeOutProgress.at(elapsedTime);
+  FastLED.setBrightness(easeScale(startBrightness, 255 - ease8(fadeOutCurve, progress)));
   stableShow();
   return false;
 }
@@ -227,17 +242,15 @@ bool BreathStarlight::wakeUp() {
     FastLED.setBrightness(TARGET_BRIGHTNESS);
     stableShow();
     startTime = 0;
-    lastStarSpawn = millis();
-    random16_set_seed(millis());
+    lastStarSpawn = timeSync.now() / STAR_SPAWN_INTERVAL;
     return true;
   }
   
-  //按照设定时间线性渐亮（调高系统亮度到TARGET_BRIGHTNESS）
-  uint8_t brightness = TARGET_BRIGHTNESS * elapsedTime / WAKE_UP_DURATION;
-  FastLED.setBrightness(brightness);
+  //按照设定时间和缓动曲线渐亮（调高系统亮度到TARGET_BRIGHTNESS）
+  uint8_t progress = wakeUpProgress.at(elapsedTime);
+  FastLED.setBrightness(easeScale(TARGET_BRIGHTNESS, ease8(wakeCurve, progress)));
   
   // 从中心向外扩散
-  uint8_t progress = (elapsedTime * 256) / WAKE_UP_DURATION;
   uint8_t litLeds = scale8(Config::MAIN_NUM_LEDS, progress);
   
   fill_solid(mainLeds, Config::MAIN_NUM_LEDS, CRGB::Black);
@@ -255,25 +268,65 @@ bool BreathStarlight::wakeUp() {
   return false;
 }
 
+// 帧节拍由控制器的帧调度器决定（Config::STARLIGHT_FPS）
 void BreathStarlight::STATE_normal(){
-  unsigned long currentMillis = millis();
-    if (currentMillis - previousMillis >= UPDATE_INTERVAL) {
-      
-      previousMillis = currentMillis;
+  render();
+  stableShow();
+}
 
-      // 主灯环 - 稳定暖白色
-      fill_solid(mainLeds, Config::MAIN_NUM_LEDS, getWarmWhite());
+// 只渲染到缓冲区不请求刷新，离线渲染也走这里
+void BreathStarlight::render(){
+  // 主灯环 - 亮度和色温随位置和时间缓慢漂移的暖白色，基准色温跟随昼夜节律
+  configureNaturalLight();
+  naturalLight.render(mainLeds, Config::MAIN_NUM_LEDS, timeSync.now());
 
-      // 星光系统更新
-      trySpawnStar();  // 尝试生成新星
-      updateStars();   // 更新所有星光状态
-      renderStars();   // 渲染到环形灯
+  // 星光系统更新
+  trySpawnStar();  // 尝试生成新星
+  updateStars();   // 更新所有星光状态
+  renderStars(ringLeds);   // 渲染到环形灯
+}
 
-      stableShow();
-    }
+// 只更新和渲染星点（背景为黑），供图层合成叠加到其他效果上
+void BreathStarlight::renderOverlay(CRGB* ring) {
+  trySpawnStar();
+  updateStars();
+  renderStars(ring);
 }
 
 /*
 下一步内容：
 
-*/
\ No newline at end of file
+*/
+
+// 切换渐变曲线，slots为FadeSlot位掩码
+void BreathStarlight::setFadeCurve(uint8_t slots, EasingCurve curve) {
+  if (slots & FADE_WAKE) wakeCurve = curve;
+  if (slots & FADE_STAR) starCurve = curve;
+  if (slots & FADE_OUT) fadeOutCurve = curve;
+}
+
+// 星光内核微基准：在独立实例和临时缓冲区上运行，不影响正在显示的星光
+void BreathStarlight::benchmark(BenchmarkSuite &suite) {
+  static CRGB scratchMain[Config::MAIN_NUM_LEDS];
+  static CRGB scratchRing[Config::RING_NUM_LEDS];
+  static BreathStarlight probe;
+  probe.begin(scratchMain, scratchRing);
+  for (int i = 0; i < MAX_STARS; i++) {
+    probe.spawnStar();
+  }
+
+  // 释放一个槽位再生成，其余星点全部活跃，覆盖最坏的位置冲突检查
+  uint8_t slot = 0;
+  suite.run("star_spawn", 200, [&]() {
+    probe.stars[slot].active = false;
+    probe.spawnStar();
+    slot = (slot + 1) % MAX_STARS;
+  });
+  suite.run("star_update", 500, [&]() { probe.updateStars(); });
+  suite.run("star_render", 500, [&]() { probe.renderStars(scratchRing); });
+
+  // 主灯环：原来的纯色填充和自然光噪声对比，保证每帧开销有界
+  uint32_t t = 0;
+  suite.run("main_flat_fill", 500, [&]() { fill_solid(scratchMain, Config::MAIN_NUM_LEDS, probe.getWarmWhite()); });
+  suite.run("main_natural_light", 500, [&]() { probe.naturalLight.render(scratchMain, Config::MAIN_NUM_LEDS, t += 10); });
+}
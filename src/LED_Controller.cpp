@@ -4,24 +4,56 @@
 #include <ArduinoJson.h>
 #include <Arduino.h>
 #include <Breath_Starlight.h>
+#include "timeline_player.h"
+#include "ddp_receiver.h"
+#include "time_sync.h"
+#include "command_queue.h"
+#include "binary_log.h"
+#include "metrics.h"
+#include "loop_profiler.h"
+#include "benchmark.h"
+#include "frame_scheduler.h"
+#include "power_manager.h"
+#include "circadian.h"
+#include "schedule.h"
+#include "segments.h"
+#include "layers.h"
+#include "spatial_effects.h"
+#include "preview_stream.h"
+#include "offline_render.h"
+#include "stress_test.h"
 
 // 初始化静态成员
 LEDController ledController;
 // MotionSensor motionsensor;
 
+// 模式显示名称，下标与LightMode一致
+static const char *const MODE_LABELS[MODE_COUNT] = {
+    "关闭", "呼吸模式", "彩虹模式", "手动调色", "自动模式", "星光模式", "时间轴", "分段", "图层"};
+
 // 构造函数
 LEDController::LEDController()
     : server(Config::serverPort()),
-      currentState(STATE_AUTO_NORMAL),
-      previousMillis(0),
       breatheStep(0),
       startHue(0),
       ringHue(0),
-      manualBlue(255),
-      manualGreen(255),
-      manualRed(255),
       targetBrightness(255),
-      globalBrightness(255)
+      globalBrightness(255),
+      manualRed(255),
+      manualGreen(255),
+      manualBlue(255),
+      currentMode(MODE_AUTO),
+      timelineUploadOk(false),
+      showPending(false),
+      phase(PHASE_OFF),
+      autoMode(true),
+      fadeInCurve(CURVE_LINEAR),
+      fadeOutCurve(CURVE_LINEAR),
+      stateVersion(1),
+      statusCacheVersion(0),
+      rootCacheVersion(0),
+      statusLength(0),
+      lastControlApply(0)
 {
 }
 
@@ -34,21 +66,74 @@ void LEDController::begin()
   FastLED.clear();
   stableShow();
 
+  timelinePlayer.begin(mainLeds, ringLeds);
+  ddpReceiver.begin(mainLeds, ringLeds);
+  previewStream.begin(mainLeds, ringLeds);
+}
+
+void LEDController::beginServer()
+{
+  // 条件请求需要读取If-None-Match，WebServer默认不保留请求头
+  static const char *headerKeys[] = {"If-None-Match"};
+  server.collectHeaders(headerKeys, 1);
+
   // 设置服务器路由
   server.on("/", [this]()
-            { this->handleRoot(); });
+            { HttpRequestTimer timer; this->handleRoot(); });
+  server.on("/status", [this]()
+            { HttpRequestTimer timer; this->handleStatus(); });
   server.on("/control", [this]()
-            { this->handleControl(); });
+            { HttpRequestTimer timer; this->handleControl(); });
+  server.on("/timeline", HTTP_GET, [this]()
+            { HttpRequestTimer timer; this->handleTimelineStats(); });
+  server.on("/timeline", HTTP_POST, [this]()
+            { HttpRequestTimer timer; this->handleTimelineUploadDone(); }, [this]()
+            { this->handleTimelineUpload(); });
+  server.on("/stream", [this]()
+            { HttpRequestTimer timer; this->handleStreamStats(); });
+  server.on("/sync", [this]()
+            { HttpRequestTimer timer; this->handleSyncStatus(); });
+  server.on("/metrics", [this]()
+            { HttpRequestTimer timer; this->handleMetrics(); });
+  server.on("/profile", [this]()
+            { HttpRequestTimer timer; this->handleProfile(); });
+  server.on("/bench", [this]()
+            { HttpRequestTimer timer; this->handleBench(); });
+  server.on("/circadian", [this]()
+            { HttpRequestTimer timer; this->handleCircadian(); });
+  server.on("/schedule", [this]()
+            { HttpRequestTimer timer; this->handleSchedule(); });
+  server.on("/segments", [this]()
+            { HttpRequestTimer timer; this->handleSegments(); });
+  server.on("/layers", [this]()
+            { HttpRequestTimer timer; this->handleLayers(); });
+  server.on("/stress", [this]()
+            { HttpRequestTimer timer; this->handleStress(); });
+  server.on("/render", [this]()
+            { HttpRequestTimer timer; this->handleRender(); });
+  server.on("/preview", [this]()
+            { HttpRequestTimer timer; this->handlePreview(); });
+  server.on("/preview/stats", [this]()
+            { HttpRequestTimer timer; this->handlePreviewStats(); });
   server.onNotFound([this]()
-                    { this->handleNotFound(); });
+                    { HttpRequestTimer timer; this->handleNotFound(); });
   server.begin();
+  previewStream.beginServer();
 }
 
 void LEDController::stableShow()
 {
+  unsigned long start = micros();
   delayMicroseconds(50);
   FastLED.show();
   delayMicroseconds(50);
+  metrics.showTime.observe(micros() - start);
+  metrics.framesShown++;
+}
+
+uint32_t LEDController::getFrameCount() const
+{
+  return metrics.framesShown;
 }
 
 bool LEDController::fadeOut()
@@ -66,14 +151,13 @@ bool LEDController::fadeOut()
   if (elapsedTime >= Config::FADE_OUT_MS)
   {
     FastLED.setBrightness(0);
-    stableShow();
+    requestShow();
     startTime = 0;
     return true;
   }
 
-  uint8_t brightness = startBrightness * (Config::FADE_OUT_MS - elapsedTime) / Config::FADE_OUT_MS;
-  FastLED.setBrightness(brightness);
-  stableShow();
+  FastLED.setBrightness(fadeOutLevel(startBrightness, elapsedTime));
+  requestShow();
   return false;
 }
 
@@ -94,32 +178,62 @@ bool LEDController::fadeIn()
   if (elapsedTime >= Config::FADE_IN_MS)
   {
     FastLED.setBrightness(LEDController::targetBrightness);
-    stableShow();
+    requestShow();
     startTime = 0;
     return true;
   }
 
-  uint8_t brightness = LEDController::targetBrightness * elapsedTime / Config::FADE_IN_MS;
-  FastLED.setBrightness(brightness);
-  fill_rainbow(mainLeds, Config::MAIN_NUM_LEDS, startHue, 255 / Config::MAIN_NUM_LEDS);
-  fill_rainbow(ringLeds, Config::RING_NUM_LEDS, startHue + 64, 255 / Config::RING_NUM_LEDS);
-  stableShow();
+  FastLED.setBrightness(fadeInLevel(LEDController::targetBrightness, elapsedTime));
+  ringHue = effectHue();
+  fill_rainbow(mainLeds, Config::MAIN_NUM_LEDS, ringHue, 255 / Config::MAIN_NUM_LEDS);
+  fill_rainbow(ringLeds, Config::RING_NUM_LEDS, ringHue + 64, 255 / Config::RING_NUM_LEDS);
+  requestShow();
   return false;
 }
 
+// 淡出/淡入亮度计算：倒数在编译期算好，每帧只查表和乘法
+static constexpr Progress8 FADE_IN_PROGRESS(Config::FADE_IN_MS);
+static constexpr Progress8 FADE_OUT_PROGRESS(Config::FADE_OUT_MS);
+
+uint8_t LEDController::fadeOutLevel(uint8_t start, uint32_t elapsed) const
+{
+  return easeScale(start, 255 - ease8(fadeOutCurve, FADE_OUT_PROGRESS.at(elapsed)));
+}
+
+uint8_t LEDController::fadeInLevel(uint8_t target, uint32_t elapsed) const
+{
+  return easeScale(target, ease8(fadeInCurve, FADE_IN_PROGRESS.at(elapsed)));
+}
+
+void LEDController::setFadeCurve(uint8_t slots, EasingCurve curve)
+{
+  if (slots & FADE_IN)
+    fadeInCurve = curve;
+  if (slots & FADE_OUT)
+    fadeOutCurve = curve;
+  breathStarlight.setFadeCurve(slots, curve);
+}
+
+// 彩虹色相由同步后的效果时钟决定，多台设备相位一致
+uint8_t LEDController::effectHue() const
+{
+  return (uint8_t)(timeSync.now() / Config::RAINBOW_HUE_STEP_MS);
+}
+
 void LEDController::setManualColor(uint8_t r, uint8_t g, uint8_t b)
 {
   manualRed = r;
   manualGreen = g;
   manualBlue = b;
 
-  if (currentState == STATE_MANUAL)
+  if (phase == PHASE_MANUAL)
   {
     fill_solid(mainLeds, Config::MAIN_NUM_LEDS, CRGB(r, g, b));
     fill_solid(ringLeds, Config::RING_NUM_LEDS, CRGB(r, g, b));
     FastLED.setBrightness(globalBrightness);
-    stableShow();
+    requestShow();
   }
+  saveSettings();
 }
 
 void LEDController::setBrightness(uint8_t brightness)
@@ -127,74 +241,316 @@ void LEDController::setBrightness(uint8_t brightness)
   globalBrightness = brightness;
   targetBrightness = brightness;
   FastLED.setBrightness(brightness);
-  stableShow();
-  Serial.println("亮度已设置为: " + String(brightness) + "%");
+  requestShow();
+  BINLOG(BRIGHTNESS_SET, brightness);
+  saveSettings();
 }
 
-void LEDController::setMode(const String &mode)
+void LEDController::saveSettings()
+{
+  touchState();
+  settingsStore.markChanged(currentSettings());
+}
+
+LightSettings LEDController::currentSettings() const
+{
+  LightSettings settings;
+  settings.brightness = globalBrightness;
+  settings.red = manualRed;
+  settings.green = manualGreen;
+  settings.blue = manualBlue;
+  settings.mode = currentMode;
+  return settings;
+}
+
+// 启动时恢复设置：只写成员变量，不刷新灯带（须在首帧之前调用）
+void LEDController::applySettings(const LightSettings &settings)
+{
+  globalBrightness = settings.brightness;
+  targetBrightness = settings.brightness;
+  manualRed = settings.red;
+  manualGreen = settings.green;
+  manualBlue = settings.blue;
+  if (settings.mode < MODE_COUNT)
+    currentMode = (LightMode)settings.mode;
+}
+
+// 按保存的模式重新进入（自动模式会强制检查一次人体状态），进不去时回到自动模式
+void LEDController::restoreMode()
+{
+  if (!setMode(currentMode))
+    setMode(MODE_AUTO);
+}
+
+const char *LEDController::modeName(LightMode mode)
 {
-  Serial.println("设置模式: " + mode);
+  return mode < MODE_COUNT ? MODE_NAMES[mode] : MODE_NAMES[MODE_AUTO];
+}
 
-  if (mode == "off")
+bool LEDController::parseMode(const String &name, LightMode &mode)
+{
+  for (uint8_t i = 0; i < MODE_COUNT; i++)
   {
-    lastState = currentState;
-    currentState = STATE_FADE_OUT;
-    FastLED.setBrightness(0);
-    stableShow();
+    if (name == MODE_NAMES[i])
+    {
+      mode = (LightMode)i;
+      return true;
+    }
   }
-  else if (mode == "breathe")
+  return false;
+}
+
+void LEDController::setMode(const String &mode)
+{
+  LightMode id;
+  if (parseMode(mode, id))
+    setMode(id);
+  else
+    BINLOG(MODE_UNKNOWN);
+}
+
+// 切换成功后才记录并保存模式；没有已上传的时间轴时返回false，保持原模式
+bool LEDController::setMode(LightMode mode)
+{
+  BINLOG(MODE_SET, mode);
+
+  if (mode == MODE_TIMELINE && !timelinePlayer.hasTimeline())
   {
-    lastState = currentState;
-    // currentState = STATE_BREATHE_LOOP;
-    currentState = STATE_BREATHE;
-    breatheStep = 0;
+    BINLOG(TIMELINE_MISSING);
+    return false;
   }
-  else if (mode == "rainbow")
+
+  switch (mode)
   {
-    lastState = currentState;
-    currentState = STATE_FADE_IN;
-    startHue = 0;
-    ringHue = 0;
+  case MODE_OFF:
+    FastLED.setBrightness(0);
+    requestShow();
+    dispatch(EV_MODE_OFF);
+    break;
+  case MODE_BREATHE:
+    dispatch(EV_MODE_BREATHE);
+    break;
+  case MODE_RAINBOW:
+    dispatch(EV_MODE_RAINBOW);
+    break;
+  case MODE_MANUAL:
+    dispatch(EV_MODE_MANUAL);
+    break;
+  case MODE_AUTO:
+    autoMode = true;
+    motionsensor.CheckMotion(1); // 强制检查，结果以CMD_MOTION命令在本帧内执行
+    break;
+  case MODE_STARLIGHT:
+    dispatch(EV_MODE_STARLIGHT);
+    break;
+  case MODE_TIMELINE:
+    dispatch(EV_MODE_TIMELINE);
+    break;
+  case MODE_SEGMENTS:
+    dispatch(EV_MODE_SEGMENTS);
+    break;
+  case MODE_LAYERS:
+    dispatch(EV_MODE_LAYERS);
+    break;
+  default:
+    return false;
   }
-  else if (mode == "manual")
+
+  currentMode = mode;
+  saveSettings();
+  return true;
+}
+
+// 人体传感器事件：非自动模式下由转移表忽略，切走自动模式前排队的强制检查结果也随之作废
+void LEDController::applyMotion(bool detected)
+{
+  dispatch(detected ? EV_MOTION_ON : EV_MOTION_OFF);
+}
+
+// 状态转移：查表得到后继阶段，依次执行退出/进入动作
+void LEDController::dispatch(Event event)
+{
+  Phase next = TRANSITIONS.next[autoMode ? 1 : 0][phase][event];
+  if (next == PHASE_NONE)
+    return;
+
+  if (EVENT_CLEARS_AUTO[event])
+    autoMode = false;
+
+  exitPhase(phase);
+  phase = next;
+  enterPhase(next);
+  touchState();
+}
+
+// 状态栏相关的内容（模式、阶段、亮度、颜色）变化时调用，缓存在下次请求时重建
+void LEDController::touchState()
+{
+  stateVersion++;
+}
+
+// 带上ETag；客户端持有的版本与当前一致时直接回304，不生成响应体
+bool LEDController::notModified(char prefix)
+{
+  char etag[16];
+  snprintf(etag, sizeof(etag), "\"%c%lu\"", prefix, (unsigned long)stateVersion);
+  server.sendHeader("ETag", etag);
+  server.sendHeader("Cache-Control", "no-cache");
+  if (server.header("If-None-Match") != etag)
+    return false;
+  metrics.statusNotModified++;
+  server.send(304);
+  return true;
+}
+
+// 各阶段目标帧率，0为静态画面（进入时渲染一次）
+static const uint16_t PHASE_FPS[PHASE_COUNT] = {
+    FrameScheduler::FPS_STATIC, // OFF
+    Config::BREATHE_FPS,        // BREATHE
+    Config::FADE_FPS,           // FADE_IN
+    Config::RAINBOW_FPS,        // NORMAL
+    Config::FADE_FPS,           // FADE_OUT
+    FrameScheduler::FPS_STATIC, // MANUAL
+    Config::FADE_FPS,           // STARLIGHT_WAKEUP
+    Config::STARLIGHT_FPS,      // STARLIGHT_NORMAL
+    Config::TIMELINE_FPS,       // TIMELINE
+    Config::STREAM_CHECK_FPS,   // STREAM
+    Config::SEGMENTS_FPS,       // SEGMENTS
+    Config::LAYERS_FPS          // LAYERS
+};
+
+void LEDController::enterPhase(Phase p)
+{
+  frameScheduler.setTargetFps(PHASE_FPS[p]);
+
+  switch (p)
   {
-    lastState = currentState;
-    currentState = STATE_MANUAL;
+  case PHASE_OFF:
+  case PHASE_BREATHE:
+    breatheStep = 0;
+    break;
+  case PHASE_FADE_IN:
+    startHue = 0;
+    break;
+  case PHASE_MANUAL:
     setManualColor(manualRed, manualGreen, manualBlue);
+    break;
+  case PHASE_STARLIGHT_WAKEUP:
+    breathStarlight.begin(mainLeds, ringLeds);
+    break;
+  case PHASE_TIMELINE:
+    // 文件头损坏时start()失败，update()中随即以EV_DONE淡出
+    timelinePlayer.start();
+    FastLED.setBrightness(globalBrightness);
+    break;
+  case PHASE_STREAM:
+    BINLOG(STREAM_START);
+    FastLED.setBrightness(globalBrightness);
+    break;
+  case PHASE_SEGMENTS:
+    FastLED.setBrightness(globalBrightness);
+    break;
+  case PHASE_LAYERS:
+    layerStack.begin();
+    FastLED.setBrightness(globalBrightness);
+    break;
+  default:
+    break;
   }
-  else if (mode == "auto")
+}
+
+void LEDController::exitPhase(Phase p)
+{
+  switch (p)
   {
+  case PHASE_OFF:
+    // 在渲染新阶段首帧之前恢复全速
+    powerManager.wake();
+    break;
+  case PHASE_TIMELINE:
+    // 离开时间轴模式时关闭文件句柄
+    timelinePlayer.stop();
+    break;
+  default:
+    break;
+  }
+}
+
+// 滑块/取色器的最新值：动画阶段随帧应用，静态阶段没有帧节拍，按CONTROL_APPLY_FPS限速
+void LEDController::applyLatestControls(bool frame)
+{
+  unsigned long now = millis();
+  if (!frame && (PHASE_FPS[phase] != FrameScheduler::FPS_STATIC ||
+                 now - lastControlApply < 1000 / Config::CONTROL_APPLY_FPS))
+    return;
 
-    motionsensor.CheckMotion(1);//Force check
-    // currentMotionState = digitalRead(Config::MOTION_SENSOR_PIN);
-    // if (currentMotionState) {
-    //   currentState = STATE_BREATHE;
-    //   breatheStep = 0;
+  uint32_t value;
+  bool applied = false;
+  if (brightnessSlot.take(value))
+  {
+    setBrightness(value);
+    applied = true;
   }
-  else if (mode == "starlight")
+  if (colorSlot.take(value))
   {
-    lastState = currentState;
-    currentState = STATE_STARLIGHT_WAKEUP;
+    setManualColor(value >> 16, (value >> 8) & 0xFF, value & 0xFF);
+    applied = true;
   }
-  
+  if (applied)
+    lastControlApply = now;
 }
 
-void LEDController::setState(SystemState NewState) {
-    lastState = currentState;
-    currentState = NewState;
+// 客户端拖动滑块时的建议发送频率：动画阶段为效果帧率，静态阶段为应用限速
+uint16_t LEDController::controlFps() const
+{
+  return PHASE_FPS[phase] ? PHASE_FPS[phase] : Config::CONTROL_APPLY_FPS;
+}
+
+// 每帧开始时取出所有外部命令，按到达顺序执行
+void LEDController::drainCommands()
+{
+  Command cmd;
+  while (commandQueue.pop(cmd))
+  {
+    switch (cmd.type)
+    {
+    case CMD_SET_MODE:
+      if (cmd.arg0 < MODE_COUNT)
+        setMode((LightMode)cmd.arg0);
+      break;
+    case CMD_SET_BRIGHTNESS:
+      setBrightness(cmd.arg0);
+      break;
+    case CMD_SET_COLOR:
+      setManualColor(cmd.arg0, cmd.arg1, cmd.arg2);
+      break;
+    case CMD_MOTION:
+      applyMotion(cmd.arg0);
+      break;
+    case CMD_SET_CURVE:
+      if (cmd.arg1 < CURVE_COUNT)
+        setFadeCurve(cmd.arg0, (EasingCurve)cmd.arg1);
+      break;
+    case CMD_STOP:
+      dispatch(EV_STOP);
+      break;
+    }
+  }
 }
 
-SystemState LEDController::getState() const {
-    return currentState;
+void LEDController::requestShow()
+{
+  showPending = true;
 }
 
-void LEDController::setBreathStep(uint16_t NewBreathStep) {
-    breatheStep = NewBreathStep;
+Phase LEDController::getPhase() const
+{
+  return phase;
 }
 
-void LEDController::setStartHue(uint8_t hue) {
-    startHue = hue;
-    ringHue = hue;
+bool LEDController::isAuto() const
+{
+  return autoMode;
 }
 
 void LEDController::quickTestLeds()
@@ -226,8 +582,43 @@ void LEDController::quickTestLeds()
 
 void LEDController::handleRoot()
 {
-  Serial.println("收到网页请求");
+  BINLOG(ROOT_REQUEST);
+  if (notModified('r'))
+    return;
+  if (rootCacheVersion != stateVersion)
+  {
+    rootCache = buildRootPage();
+    rootCacheVersion = stateVersion;
+  }
+  server.send(200, "text/html", rootCache);
+}
+
+// 状态轮询：未变化时只比较一次请求头，变化后只重建一次
+void LEDController::handleStatus()
+{
+  metrics.statusRequests++;
+  if (notModified('s'))
+    return;
+  if (statusCacheVersion != stateVersion)
+    renderStatus();
+  server.send_P(200, "application/json", statusCache, statusLength);
+}
+
+void LEDController::renderStatus()
+{
+  int length = snprintf(statusCache, sizeof(statusCache),
+                        "{\"version\":%lu,\"mode\":\"%s\",\"status\":\"%s\",\"phase\":\"%s\","
+                        "\"auto\":%s,\"brightness\":%ld,\"color\":\"#%02x%02x%02x\"}",
+                        (unsigned long)stateVersion, modeName(currentMode), statusLabel(), phaseName(phase),
+                        autoMode ? "true" : "false", map(globalBrightness, 0, 255, 0, 100),
+                        manualRed, manualGreen, manualBlue);
+  statusLength = length < (int)sizeof(statusCache) ? length : sizeof(statusCache) - 1;
+  statusCacheVersion = stateVersion;
+  metrics.statusRenders++;
+}
 
+String LEDController::buildRootPage() const
+{
   String html = R"rawliteral(
 <!DOCTYPE HTML>
 <html>
@@ -301,11 +692,7 @@ void LEDController::handleRoot()
       <p>IP地址: )rawliteral" +
                 WiFi.localIP().toString() + R"rawliteral(</p>
       <p>状态: <span id="status">)rawliteral" +
-                (currentState == STATE_OFF ? "关闭" : currentState == STATE_BREATHE ? "呼吸模式"
-                                                  : currentState == STATE_NORMAL    ? "彩虹模式"
-                                                  : currentState == STATE_MANUAL    ? "手动调色"
-                                                  : currentState == STATE_STARLIGHT_NORMAL ? "星光模式"
-                                                                                    : "自动模式") +
+                statusLabel() +
                 R"rawliteral(</span></p>
     </div>
 
@@ -315,20 +702,42 @@ void LEDController::handleRoot()
     <button class="btn" onclick="setMode('breathe')">呼吸模式</button>
     <button class="btn" onclick="setMode('rainbow')">彩虹模式</button>
     <button class="btn" onclick="setMode('manual')">手动调色</button>
+    <button class="btn" onclick="setMode('timeline')">时间轴</button>
+    <button class="btn" onclick="setMode('segments')">分段</button>
+    <button class="btn" onclick="setMode('layers')">图层</button>
     <button class="btn btn-auto" onclick="setMode('auto')">自动模式</button>
 
     <div class="slider-container">
       <h3>亮度控制: <span id="brightnessValue">)rawliteral" +
                 String(map(globalBrightness, 0, 255, 0, 100)) + R"rawliteral(</span>%</h3>
       <input type="range" min="0" max="100" value=")rawliteral" +
-                String(map(globalBrightness, 0, 255, 0, 100)) + R"rawliteral(" class="slider" id="brightnessSlider" onchange="setBrightness(this.value)">
+                String(map(globalBrightness, 0, 255, 0, 100)) + R"rawliteral(" class="slider" id="brightnessSlider" oninput="setBrightness(this.value)">
     </div>
 
+    <h3>渐变曲线</h3>
+    <select class="btn" onchange="setCurve(this.value)">
+      <option value="linear">线性</option>
+      <option value="in">缓入</option>
+      <option value="out">缓出</option>
+      <option value="in_out">缓入缓出</option>
+      <option value="sine">正弦</option>
+      <option value="expo">指数</option>
+      <option value="cie">感知亮度(CIE)</option>
+    </select>
+
     <div id="colorControl" style="display: )rawliteral" +
-                (currentState == STATE_MANUAL ? "block" : "none") + R"rawliteral(;">
+                (phase == PHASE_MANUAL ? "block" : "none") + R"rawliteral(;">
       <h3>颜色选择</h3>
-      <input type="color" class="color-picker" id="colorPicker" onchange="setColor(this.value)" value="#ffffff">
+      <input type="color" class="color-picker" id="colorPicker" oninput="setColor(this.value)" value="#ffffff">
     </div>
+
+    <h3>上传时间轴 (.lkt)</h3>
+    <form method="POST" action="/timeline" enctype="multipart/form-data">
+      <input type="file" name="timeline" accept=".lkt">
+      <button class="btn" type="submit">上传</button>
+    </form>
+
+    <p><a href="/preview" style="color: white;">实时预览</a></p>
   </div>
 
   <script>
@@ -342,25 +751,74 @@ void LEDController::handleRoot()
         });
     }
 
+    // 拖动时节流：上一个请求返回且间隔一帧后才发下一个，期间只保留最新值；帧率取自设备应答
+    let frameMs = 33;
+    function throttle(send) {
+      let pending = null;
+      let busy = false;
+      function flush() {
+        if (pending === null) {
+          busy = false;
+          return;
+        }
+        const value = pending;
+        pending = null;
+        busy = true;
+        send(value)
+          .then(response => response.json())
+          .then(data => { if (data.fps) frameMs = 1000 / data.fps; })
+          .catch(() => {})
+          .finally(() => setTimeout(flush, frameMs));
+      }
+      return value => {
+        pending = value;
+        if (!busy) flush();
+      };
+    }
+
+    const sendBrightness = throttle(value => fetch('/control?brightness=' + value));
     function setBrightness(value) {
       document.getElementById('brightnessValue').innerText = value;
-      fetch('/control?brightness=' + value)
+      sendBrightness(value);
+    }
+
+    function setCurve(curve) {
+      fetch('/control?curve=' + curve)
         .then(response => response.json());
     }
 
-    function setColor(color) {
+    // 定时拉取状态；no-cache让浏览器带If-None-Match重新验证，未变化时设备只回304
+    function refreshStatus() {
+      fetch('/status', { cache: 'no-cache' })
+        .then(response => response.json())
+        .then(data => {
+          document.getElementById('status').innerText = data.status;
+          // 正在拖动的滑块不被轮询结果拉回
+          if (document.activeElement.id !== 'brightnessSlider') {
+            document.getElementById('brightnessValue').innerText = data.brightness;
+            document.getElementById('brightnessSlider').value = data.brightness;
+          }
+          document.getElementById('colorControl').style.display =
+            (data.phase === 'manual') ? 'block' : 'none';
+        });
+    }
+    setInterval(refreshStatus, 2000);
+
+    const sendColor = throttle(color => {
       const r = parseInt(color.substr(1,2), 16);
       const g = parseInt(color.substr(3,2), 16);
       const b = parseInt(color.substr(5,2), 16);
-      fetch('/control?r=' + r + '&g=' + g + '&b=' + b)
-        .then(response => response.json());
+      return fetch('/control?r=' + r + '&g=' + g + '&b=' + b);
+    });
+    function setColor(color) {
+      sendColor(color);
     }
   </script>
 </body>
 </html>
 )rawliteral";
 
-  server.send(200, "text/html", html);
+  return html;
 }
 
 void LEDController::handleClient()
@@ -368,23 +826,45 @@ void LEDController::handleClient()
   server.handleClient();
 }
 
+// 网页请求只投递命令，不直接改动状态和灯带；命令在下一帧开始时执行
 void LEDController::handleControl()
 {
-  Serial.println("收到控制请求");
+  BINLOG(CONTROL_REQUEST);
 
   String message = "";
+  const char *pendingLabel = nullptr;
+  int pendingBrightness = -1;
+  bool queued = true;
+  uint8_t commands = 0;
 
   if (server.hasArg("mode"))
   {
     String mode = server.arg("mode");
-    setMode(mode);
-    message = "模式已设置为: " + mode;
+    LightMode id;
+    if (!parseMode(mode, id))
+    {
+      message = "未知模式: " + mode;
+    }
+    else if (id == MODE_TIMELINE && !timelinePlayer.hasTimeline())
+    {
+      message = "尚未上传时间轴，保持当前模式";
+    }
+    else
+    {
+      queued &= commandQueue.push(Command{CMD_SET_MODE, (uint8_t)id, 0, 0});
+      commands++;
+      pendingLabel = MODE_LABELS[id];
+      message = "模式已设置为: " + mode;
+    }
   }
 
+  // 亮度和颜色只保留最新值，由update()每帧应用一次；未应用就被覆盖的旧值计入合并数
   if (server.hasArg("brightness"))
   {
-    int brightness = server.arg("brightness").toInt();
-    setBrightness(map(brightness, 0, 100, 0, 255));
+    int brightness = constrain((int)server.arg("brightness").toInt(), 0, 100);
+    if (brightnessSlot.post(map(brightness, 0, 100, 0, 255)))
+      metrics.controlCoalesced++;
+    pendingBrightness = brightness;
   }
 
   if (server.hasArg("r") && server.hasArg("g") && server.hasArg("b"))
@@ -392,37 +872,401 @@ void LEDController::handleControl()
     uint8_t r = server.arg("r").toInt();
     uint8_t g = server.arg("g").toInt();
     uint8_t b = server.arg("b").toInt();
-    setManualColor(r, g, b);
+    if (colorSlot.post(((uint32_t)r << 16) | (g << 8) | b))
+      metrics.controlCoalesced++;
     message += " 颜色已设置";
   }
 
-  String statusText = "";
-  switch (currentState)
+  // 渐变曲线：fade可选 in/out/wake/star，缺省为全部
+  if (server.hasArg("curve"))
   {
-  case STATE_OFF:
-    statusText = "关闭";
-    break;
-  case STATE_BREATHE:
-    statusText = "呼吸模式";
-    break;
-  case STATE_NORMAL:
-    statusText = "彩虹模式";
-    break;
-  case STATE_MANUAL:
-    statusText = "手动调色";
-    break;
-  case STATE_STARLIGHT_NORMAL:
-    statusText = "星光模式";
-    break;
+    EasingCurve curve;
+    if (parseCurve(server.arg("curve").c_str(), curve))
+    {
+      String fade = server.arg("fade");
+      uint8_t slots = fade == "in" ? FADE_IN : fade == "out" ? FADE_OUT : fade == "wake" ? FADE_WAKE : fade == "star" ? FADE_STAR : FADE_ALL;
+      queued &= commandQueue.push(Command{CMD_SET_CURVE, slots, (uint8_t)curve, 0});
+      commands++;
+      message += " 曲线已设置为: " + server.arg("curve");
+    }
+    else
+    {
+      message += " 未知曲线: " + server.arg("curve");
+    }
+  }
+
+  // 日志开关：用于对比开/关日志时的循环耗时
+  if (server.hasArg("log"))
+  {
+    binaryLog.setEnabled(server.arg("log").toInt() != 0);
+  }
+
+  BINLOG(CONTROL_RESPONSE, commands, queued);
+
+  if (!queued)
+  {
+    server.send(503, "application/json", "{\"message\":\"busy\"}");
+    return;
+  }
+
+  // 只有滑块/取色器的请求（拖动时每秒几十次）：简短应答，附带建议的发送帧率
+  if (commands == 0 && !server.hasArg("mode") && !server.hasArg("curve"))
+  {
+    char ack[48];
+    snprintf(ack, sizeof(ack), "{\"ok\":true,\"fps\":%u}", controlFps());
+    server.send(200, "application/json", ack);
+    return;
+  }
+
+  // 命令尚未执行，状态以刚投递的模式为准
+  String statusText = pendingLabel ? pendingLabel : statusLabel();
+  int brightnessPercent = pendingBrightness >= 0 ? pendingBrightness : map(globalBrightness, 0, 255, 0, 100);
+
+  server.send(200, "application/json", buildControlJson(statusText, message, brightnessPercent));
+}
+
+String LEDController::buildControlJson(const String &status, const String &message, int brightnessPercent) const
+{
+  return "{\"status\":\"" + status + "\",\"message\":\"" + message + "\",\"brightness\":" + String(brightnessPercent) + ",\"flashWrites\":" + String(settingsStore.getWriteCount()) + "}";
+}
+
+const char *LEDController::statusLabel() const
+{
+  if (autoMode)
+    return "自动模式";
+
+  switch (phase)
+  {
+  case PHASE_OFF:
+  case PHASE_FADE_OUT:
+    return "关闭";
+  case PHASE_BREATHE:
+    return "呼吸模式";
+  case PHASE_FADE_IN:
+  case PHASE_NORMAL:
+    return "彩虹模式";
+  case PHASE_MANUAL:
+    return "手动调色";
+  case PHASE_STARLIGHT_WAKEUP:
+  case PHASE_STARLIGHT_NORMAL:
+    return "星光模式";
+  case PHASE_TIMELINE:
+    return "时间轴";
+  case PHASE_STREAM:
+    return "像素流";
+  case PHASE_SEGMENTS:
+    return "分段";
+  case PHASE_LAYERS:
+    return "图层";
   default:
-    statusText = "自动模式";
-    break;
+    return "自动模式";
+  }
+}
+
+// 时间轴上传：分块写入LittleFS，不在内存中缓存整个文件
+void LEDController::handleTimelineUpload()
+{
+  HTTPUpload &upload = server.upload();
+  if (upload.status == UPLOAD_FILE_START)
+  {
+    // 正在播放的时间轴先停止，淡出由下一帧执行的停止命令完成
+    commandQueue.push(Command{CMD_STOP, 0, 0, 0});
+    timelinePlayer.uploadBegin();
+  }
+  else if (upload.status == UPLOAD_FILE_WRITE)
+  {
+    timelinePlayer.uploadWrite(upload.buf, upload.currentSize);
+  }
+  else if (upload.status == UPLOAD_FILE_END)
+  {
+    timelineUploadOk = timelinePlayer.uploadEnd();
+    Serial.println(timelineUploadOk ? "时间轴上传完成" : "时间轴文件无效");
+  }
+  else if (upload.status == UPLOAD_FILE_ABORTED)
+  {
+    timelineUploadOk = false;
+    timelinePlayer.uploadEnd();
+  }
+}
+
+void LEDController::handleTimelineUploadDone()
+{
+  if (timelineUploadOk)
+    server.send(200, "application/json", "{\"uploaded\":true}");
+  else
+    server.send(400, "application/json", "{\"uploaded\":false}");
+  timelineUploadOk = false;
+}
+
+// 时间轴播放统计：每帧解码耗时和缓冲区峰值
+void LEDController::handleTimelineStats()
+{
+  const TimelinePlayer::Stats &stats = timelinePlayer.getStats();
+  uint32_t avg = stats.frames ? stats.decodeUsTotal / stats.frames : 0;
+  String json = "{\"playing\":" + String(timelinePlayer.isPlaying() ? "true" : "false") +
+                ",\"frames\":" + String(stats.frames) +
+                ",\"decodeUsAvg\":" + String(avg) +
+                ",\"decodeUsMax\":" + String(stats.decodeUsMax) +
+                ",\"bufferPeak\":" + String(stats.bufferPeak) + "}";
+  server.send(200, "application/json", json);
+}
+
+// 像素流接收统计
+void LEDController::handleStreamStats()
+{
+  const DdpReceiver::Stats &stats = ddpReceiver.getStats();
+  String json = "{\"active\":" + String(ddpReceiver.isActive() ? "true" : "false") +
+                ",\"packets\":" + String(stats.packets) +
+                ",\"frames\":" + String(stats.frames) +
+                ",\"lost\":" + String(stats.lost) +
+                ",\"outOfOrder\":" + String(stats.outOfOrder) +
+                ",\"malformed\":" + String(stats.malformed) + "}";
+  server.send(200, "application/json", json);
+}
+
+// 时间同步状态
+void LEDController::handleSyncStatus()
+{
+  TimeSync::Status status = timeSync.getStatus();
+  String json = "{\"nodeId\":" + String(status.nodeId) +
+                ",\"leaderId\":" + String(status.leaderId) +
+                ",\"leader\":" + String(status.leader ? "true" : "false") +
+                ",\"synced\":" + String(status.synced ? "true" : "false") +
+                ",\"offsetMs\":" + String(status.offsetMs) +
+                ",\"driftPpm\":" + String(status.driftPpm, 1) +
+                ",\"rttUs\":" + String(status.lastRttUs) +
+                ",\"peers\":" + String(status.peers) + "}";
+  server.send(200, "application/json", json);
+}
+
+// Prometheus文本格式指标，输出到静态缓冲区，不产生堆分配
+void LEDController::handleMetrics()
+{
+  static char buffer[6144];
+  size_t length = metrics.render(buffer, sizeof(buffer));
+  length += frameScheduler.renderMetrics(buffer + length, sizeof(buffer) - length);
+  length += powerManager.renderMetrics(buffer + length, sizeof(buffer) - length);
+  server.send_P(200, "text/plain; version=0.0.4", buffer, length);
+}
+
+// 主循环剖析报告，reset=1时输出后清零
+void LEDController::handleProfile()
+{
+  static char buffer[2048];
+  size_t length = loopProfiler.render(buffer, sizeof(buffer));
+  server.send_P(200, "text/plain", buffer, length);
+  if (server.arg("reset") == "1")
+    loopProfiler.reset();
+}
+
+// 内核微基准：同步执行约几十毫秒，期间不刷新灯带；全部在临时缓冲区上运行，不影响当前效果
+void LEDController::handleBench()
+{
+  static char buffer[3072];
+  static CRGB scratchMain[Config::MAIN_NUM_LEDS];
+  static CRGB scratchRing[Config::RING_NUM_LEDS];
+  volatile uint32_t sink = 0;
+  uint32_t elapsed = 0;
+  uint8_t hue = 0;
+
+  BenchmarkSuite suite;
+  suite.run("fill_rainbow_main", 500, [&]()
+            { fill_rainbow(scratchMain, Config::MAIN_NUM_LEDS, hue++, 255 / Config::MAIN_NUM_LEDS); });
+  suite.run("fill_rainbow_ring", 500, [&]()
+            { fill_rainbow(scratchRing, Config::RING_NUM_LEDS, hue++, 255 / Config::RING_NUM_LEDS); });
+  suite.run("fade_math", 1000, [&]()
+            {
+              elapsed = (elapsed + 7) % Config::FADE_IN_MS;
+              sink = fadeInLevel(targetBrightness, elapsed) + fadeOutLevel(globalBrightness, elapsed); });
+  breathStarlight.benchmark(suite);
+  segmentCompositor.benchmark(suite);
+  layerStack.benchmark(suite);
+  benchmarkSpatialEffects(suite);
+  suite.run("root_html", 50, [&]()
+            { sink = buildRootPage().length(); });
+  suite.run("control_json", 200, [&]()
+            { sink = buildControlJson(statusLabel(), "模式已设置为: rainbow", 80).length(); });
+  (void)sink;
+
+  size_t length = suite.render(buffer, sizeof(buffer));
+  server.send_P(200, "application/json", buffer, length);
+}
+
+// 昼夜节律：curve=分钟,色温,百分比;... 替换曲线，time=HH:MM 切到手动时钟，time=sntp 切回
+void LEDController::handleCircadian()
+{
+  if (server.hasArg("curve") && !circadian.parseCurve(server.arg("curve")))
+  {
+    server.send(400, "application/json", "{\"error\":\"invalid curve\"}");
+    return;
+  }
+  if (server.hasArg("time"))
+  {
+    String value = server.arg("time");
+    unsigned hour, minute;
+    if (value == "sntp")
+      circadian.useSntp();
+    else if (sscanf(value.c_str(), "%u:%u", &hour, &minute) == 2 && hour < 24 && minute < 60)
+      circadian.setManualTime(hour * 3600UL + minute * 60UL);
+    else
+    {
+      server.send(400, "application/json", "{\"error\":\"invalid time\"}");
+      return;
+    }
+  }
+
+  String json = "{\"clock\":\"" + String(circadian.isManual() ? "manual" : "sntp") +
+                "\",\"valid\":" + String(circadian.clockValid() ? "true" : "false") +
+                ",\"secondsOfDay\":" + String(circadian.getSecondsOfDay()) +
+                ",\"kelvin\":" + String(circadian.getKelvin()) +
+                ",\"scale\":" + String(circadian.getScale()) +
+                ",\"curve\":\"" + circadian.curveString() + "\"}";
+  server.send(200, "application/json", json);
+}
+
+// 模式日程：set=HH:MM=模式;... 替换整张表（set= 为空则清空），到点经命令队列切换模式
+void LEDController::handleSchedule()
+{
+  if (server.hasArg("set") && !modeSchedule.parse(server.arg("set")))
+  {
+    server.send(400, "application/json", "{\"error\":\"invalid schedule\"}");
+    return;
   }
 
-  String json = "{\"status\":\"" + statusText + "\",\"message\":\"" + message + "\",\"brightness\":" + String(map(globalBrightness, 0, 255, 0, 100)) + "}";
+  const ModeSchedule::Stats &stats = modeSchedule.getStats();
+  String json = "{\"entries\":\"" + modeSchedule.toString() + "\"";
+  ModeSchedule::Entry next;
+  uint32_t inMs;
+  // 新表在下一次主循环才排入堆中，刚提交时可能还没有next
+  if (modeSchedule.nextEntry(next, inMs, millis()))
+  {
+    char time[6];
+    snprintf(time, sizeof(time), "%02u:%02u", next.minute / 60, next.minute % 60);
+    json += ",\"next\":{\"time\":\"" + String(time) +
+            "\",\"mode\":\"" + String(modeName((LightMode)next.mode)) +
+            "\",\"inSeconds\":" + String(inMs / 1000) + "}";
+  }
+  json += ",\"fired\":" + String(stats.fired) +
+          ",\"dropped\":" + String(stats.dropped) +
+          ",\"rebuilds\":" + String(stats.rebuilds) + "}";
   server.send(200, "application/json", json);
+}
 
-  Serial.println("控制响应: " + message);
+// 分段布局：set=灯带,起点,长度,标志,效果,颜色,周期;... 替换整个布局，下一帧生效
+void LEDController::handleSegments()
+{
+  if (server.hasArg("set") && !segmentCompositor.parse(server.arg("set")))
+  {
+    server.send(400, "application/json", "{\"error\":\"invalid segments\"}");
+    return;
+  }
+  String json = "{\"count\":" + String(segmentCompositor.getCount()) +
+                ",\"segments\":\"" + segmentCompositor.toString() + "\"}";
+  server.send(200, "application/json", json);
+}
+
+// 图层栈：set=来源,混合,不透明度;... 自下而上替换整个图层栈，下一帧生效
+void LEDController::handleLayers()
+{
+  if (server.hasArg("set") && !layerStack.parse(server.arg("set")))
+  {
+    server.send(400, "application/json", "{\"error\":\"invalid layers\"}");
+    return;
+  }
+  String json = "{\"count\":" + String(layerStack.getCount()) +
+                ",\"layers\":\"" + layerStack.toString() + "\"}";
+  server.send(200, "application/json", json);
+}
+
+// 压力测试：/stress?clients=&seconds=&budget= 启动（seconds为每个效果的时长），不带参数时返回进度或结果
+void LEDController::handleStress()
+{
+  static char buffer[2048];
+  if (server.hasArg("clients"))
+  {
+    long clients = server.arg("clients").toInt();
+    long seconds = server.hasArg("seconds") ? server.arg("seconds").toInt() : 5;
+    long budget = server.hasArg("budget") ? server.arg("budget").toInt() : (long)Config::STRESS_JITTER_BUDGET_US;
+    if (clients < 1 || clients > Config::STRESS_MAX_CLIENTS || seconds < 1 || seconds > Config::STRESS_MAX_SECONDS ||
+        budget < 0 || !stressTest.start(clients, seconds, budget))
+    {
+      server.send(400, "application/json", "{\"error\":\"invalid stress\"}");
+      return;
+    }
+  }
+  size_t length = stressTest.render(buffer, sizeof(buffer));
+  server.send_P(200, "application/json", buffer, length);
+}
+
+// 离线渲染：/render?mode=&seconds=&fps=&format=ppm|raw 导出帧序列，PPM每行为一帧；
+// 不带mode时返回当前或上一次渲染的进度和吞吐量。导出由主循环分片完成，实时显示不受影响
+void LEDController::handleRender()
+{
+  if (!server.hasArg("mode"))
+  {
+    const OfflineRenderer::Stats &stats = offlineRenderer.getStats();
+    String json = "{\"mode\":\"" + String(modeName((LightMode)stats.mode)) +
+                  "\",\"fps\":" + String(stats.fps) +
+                  ",\"running\":" + String(stats.running ? "true" : "false") +
+                  ",\"frames\":" + String(stats.frames) +
+                  ",\"totalFrames\":" + String(stats.totalFrames) +
+                  ",\"renderUs\":" + String(stats.renderUs) +
+                  ",\"framesPerSecond\":" + String(offlineRenderer.framesPerSecond()) + "}";
+    server.send(200, "application/json", json);
+    return;
+  }
+
+  LightMode mode;
+  long seconds = server.hasArg("seconds") ? server.arg("seconds").toInt() : 10;
+  long fps = server.hasArg("fps") ? server.arg("fps").toInt() : 50;
+  if (!parseMode(server.arg("mode"), mode) || !OfflineRenderer::supports(mode) ||
+      fps < 1 || fps > Config::RENDER_MAX_FPS || seconds < 1 ||
+      seconds * fps > (long)Config::RENDER_MAX_FRAMES)
+  {
+    server.send(400, "application/json", "{\"error\":\"invalid render\"}");
+    return;
+  }
+  if (offlineRenderer.isExporting())
+  {
+    server.send(503, "application/json", "{\"error\":\"render busy\"}");
+    return;
+  }
+
+  uint32_t frames = seconds * fps;
+  bool raw = server.arg("format") == "raw";
+  char header[32];
+  int headerLength = raw ? 0 : snprintf(header, sizeof(header), "P6\n%u %lu\n255\n",
+                                        OfflineRenderer::PIXELS, (unsigned long)frames);
+  server.setContentLength(headerLength + frames * OfflineRenderer::ROW_BYTES);
+  server.send(200, raw ? "application/octet-stream" : "image/x-portable-pixmap", "");
+  if (headerLength > 0)
+    server.sendContent(header, headerLength);
+
+  // 帧数据由主循环分片渲染并写入这个连接，处理函数立即返回
+  offlineRenderer.beginExport(server.client(), mode, fps, frames);
+}
+
+// 预览页本身走端口80，帧数据由它再连端口81拉取
+void LEDController::handlePreview()
+{
+  server.send(200, "text/html", previewStream.viewerPage());
+}
+
+void LEDController::handlePreviewStats()
+{
+  const PreviewStream::Stats &stats = previewStream.getStats();
+  String json = "{\"connected\":" + String(previewStream.isConnected() ? "true" : "false") +
+                ",\"fps\":" + String(previewStream.getFps()) +
+                ",\"clients\":" + String(stats.clients) +
+                ",\"frames\":" + String(stats.frames) +
+                ",\"keyframes\":" + String(stats.keyframes) +
+                ",\"dropped\":" + String(stats.dropped) +
+                ",\"unchanged\":" + String(stats.unchanged) +
+                ",\"bytes\":" + String(stats.bytes) +
+                ",\"lastFrameBytes\":" + String(stats.lastFrameBytes) +
+                ",\"lastEncodeUs\":" + String(stats.lastEncodeUs) +
+                ",\"maxEncodeUs\":" + String(stats.maxEncodeUs) + "}";
+  server.send(200, "application/json", json);
 }
 
 void LEDController::handleNotFound()
@@ -442,164 +1286,124 @@ void LEDController::handleNotFound()
   server.send(404, "text/plain", message);
 }
 
-void LEDController::update()
+// 当前阶段的效果渲染
+void LEDController::renderPhase(bool streamFrame)
 {
-  // 状态机处理
-  switch (currentState)
+  switch (phase)
   {
-  case STATE_OFF:
-    if (lastState != STATE_OFF)
-    {
-      if (fadeOut())
-      {
-        lastState = currentState;
-        breatheStep = 0;
-      }
-    }
+  case PHASE_OFF:
     break;
 
-  
-  case STATE_BREATHE:
-  case STATE_AUTO_BREATH:
+  case PHASE_BREATHE:
     if (breatheStep < Config::BREATHE_STEPS)
     {
-      // Serial.println("in this loop once");
       FastLED.setBrightness(255);
       FastLED.clear();
 
-      uint8_t mainPos = (breatheStep < Config::MAIN_NUM_LEDS) ? breatheStep : (2 * Config::MAIN_NUM_LEDS - 1 - breatheStep);
-      uint8_t mainBrightness;
-      if (breatheStep < Config::MAIN_NUM_LEDS)
-      {
-        mainBrightness = (uint16_t)(breatheStep) * 255 / Config::MAIN_NUM_LEDS;
-      }
-      else
-      {
-        mainBrightness = (uint16_t)(Config::BREATHE_STEPS - breatheStep) * 255 / Config::MAIN_NUM_LEDS;
-        // mainBrightness = 255;
-      }
-      mainLeds[mainPos] = CRGB(mainBrightness, mainBrightness, mainBrightness);
-      mainLeds[mainPos+1] = CRGB(mainBrightness, mainBrightness, mainBrightness);
-
-      uint8_t ringPos = (breatheStep * Config::RING_NUM_LEDS) / Config::BREATHE_STEPS;
-      ringPos = ringPos % Config::RING_NUM_LEDS;
-      fill_solid(ringLeds, Config::RING_NUM_LEDS, CRGB::Black);
-      ringLeds[ringPos] = CRGB(mainBrightness, mainBrightness, mainBrightness);
-      ringLeds[(ringPos+1)%Config::RING_NUM_LEDS] = CRGB(mainBrightness, mainBrightness, mainBrightness);
-
-      stableShow();
-      delay(Config::BREATHE_DURATION_MS / Config::BREATHE_STEPS);
+      renderBreathe(mainLeds, ringLeds, breatheStep);
+      requestShow();
       breatheStep++;
     }
     else
     {
-      if (currentState == STATE_BREATHE)
-      {
-        //lastState = currentState;
-        //currentState = STATE_FADE_IN;
-        startHue = 0;
-        breatheStep = 0;
-      }
-      else if (currentState == STATE_AUTO_BREATH)
-      {
-        lastState = currentState;
-        currentState = STATE_AUTO_FADE_IN;
-        startHue = 0;
-        breatheStep = 0;
-      }
+      dispatch(EV_DONE);
     }
     break;
 
-  // case STATE_BREATHE_LOOP:
-  // {
-  //   FastLED.clear();
+  case PHASE_FADE_IN:
+    if (fadeIn())
+      dispatch(EV_DONE);
+    break;
 
-  //   uint16_t currentStep = breatheStep % Config::BREATHE_STEPS;
-  //   uint8_t mainPos = currentStep % Config::MAIN_NUM_LEDS;
-  //   uint8_t ringPos = currentStep % Config::RING_NUM_LEDS;
+  case PHASE_NORMAL:
+    ringHue = effectHue();
+    fill_rainbow(mainLeds, Config::MAIN_NUM_LEDS, ringHue, 255 / Config::MAIN_NUM_LEDS);
+    fill_rainbow(ringLeds, Config::RING_NUM_LEDS, ringHue + 64, 255 / Config::RING_NUM_LEDS);
+    requestShow();
+    break;
 
-  //   mainLeds[mainPos] = CRGB::White;
-  //   fill_solid(ringLeds, Config::RING_NUM_LEDS, CRGB::Black);
-  //   ringLeds[ringPos] = CRGB::White;
+  case PHASE_FADE_OUT:
+    if (fadeOut())
+      dispatch(EV_DONE);
+    break;
 
-  //   stableShow();
-  //   delay(Config::BREATHE_DURATION_MS / Config::BREATHE_STEPS);
-  //   breatheStep++;
-  //   break;
-  // }
+  case PHASE_MANUAL:
+    break;
 
-  case STATE_FADE_IN:
-  case STATE_AUTO_FADE_IN:
-    if (fadeIn())
-    {
-      if (currentState == STATE_FADE_IN)
-      {
-        lastState = currentState;
-        currentState = STATE_NORMAL;
-        // lastModeChangeTime = millis();
-        ringHue = startHue;
-      }
-      else if (currentState == STATE_AUTO_FADE_IN)
-      {
-        lastState = currentState;
-        currentState = STATE_AUTO_NORMAL;
-        // currentState = STATE_NORMAL;
-        // lastModeChangeTime = millis();
-        ringHue = startHue;
-      }
-    }
+  case PHASE_STARLIGHT_WAKEUP:
+    if (breathStarlight.wakeUp())
+      dispatch(EV_DONE);
     break;
 
-  case STATE_NORMAL:
-  case STATE_AUTO_NORMAL:
-  {
-    unsigned long currentMillis = millis();
-    if (currentMillis - previousMillis >= Config::NORMAL_UPDATE_INTERVAL)
+  case PHASE_STARLIGHT_NORMAL:
+    breathStarlight.STATE_normal();
+    break;
+
+  case PHASE_TIMELINE:
+    if (timelinePlayer.render(millis()))
+      requestShow();
+    else
+      dispatch(EV_DONE); // 非循环时间轴播放完毕，淡出
+    break;
+
+  case PHASE_STREAM:
+    if (streamFrame)
     {
-      previousMillis = currentMillis;
-      fill_rainbow(mainLeds, Config::MAIN_NUM_LEDS, ringHue, 255 / Config::MAIN_NUM_LEDS);
-      fill_rainbow(ringLeds, Config::RING_NUM_LEDS, ringHue + 64, 255 / Config::RING_NUM_LEDS);
-      ringHue += 2;
-      stableShow();
+      requestShow();
     }
-  }
-  break;
-
-  case STATE_FADE_OUT:
-  case STATE_AUTO_FADE_OUT:
-    if (fadeOut())
+    else if (!ddpReceiver.isActive())
     {
-      
-      if (currentState == STATE_FADE_OUT){
-        lastState = currentState;
-        currentState = STATE_OFF;
-        breatheStep = 0;
-      }
-      else if(currentState == STATE_AUTO_FADE_OUT){
-        lastState = currentState;
-        currentState = STATE_AUTO_OFF;
-        breatheStep = 0;
-      }
+      BINLOG(STREAM_TIMEOUT);
+      restoreMode();
     }
-    
     break;
 
-  case STATE_MANUAL:
+  case PHASE_SEGMENTS:
+    segmentCompositor.render(mainLeds, ringLeds, timeSync.now());
+    requestShow();
     break;
-  
 
-  case STATE_STARLIGHT_WAKEUP:
-  {
-    breathStarlight.begin(mainLeds, ringLeds);
-    if (breathStarlight.wakeUp()) {
-        lastState = currentState;
-        currentState = STATE_STARLIGHT_NORMAL;
-    }
+  case PHASE_LAYERS:
+    layerStack.render(mainLeds, ringLeds, timeSync.now());
+    requestShow();
+    break;
+
+  default:
     break;
   }
-  case STATE_STARLIGHT_NORMAL:
+}
+
+void LEDController::update()
+{
+  // 先执行本帧之前到达的外部命令
+  drainCommands();
+
+  // 像素流优先：收到数据即接管灯带，超时后在PHASE_STREAM中恢复原模式
+  bool streamFrame = ddpReceiver.poll();
+  if (phase != PHASE_STREAM && ddpReceiver.isActive())
   {
-    breathStarlight.STATE_normal();
+    dispatch(EV_STREAM_START);
+  }
+
+  // 各阶段按帧调度器的节拍渲染，完成时发出EV_DONE，由转移表决定后继阶段；像素流到达即渲染
+  bool frame = frameScheduler.frameDue(streamFrame);
+  applyLatestControls(frame);
+  if (frame)
+  {
+    PROFILE_SCOPE(PROF_RENDER);
+    renderPhase(streamFrame);
+  }
+
+  // 每帧最多刷新一次灯带
+  if (showPending)
+  {
+    PROFILE_SCOPE(PROF_SHOW);
+    showPending = false;
+    stableShow();
+    stressTest.noteFrame(phase, PHASE_FPS[phase]);
   }
+  else
+  {
+    metrics.framesSkipped++;
   }
-}
\ No newline at end of file
+}
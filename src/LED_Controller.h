@@ -2,6 +2,19 @@
 #define LED_CONTROLLER_H
 
 #include "config.h"
+#include "settings_store.h"
+#include "state_machine.h"
+#include "easing.h"
+
+// 可单独切换缓动曲线的渐变，按位组合
+enum FadeSlot : uint8_t
+{
+  FADE_IN = 1 << 0,   // 彩虹淡入
+  FADE_OUT = 1 << 1,  // 关灯淡出
+  FADE_WAKE = 1 << 2, // 星光唤醒
+  FADE_STAR = 1 << 3, // 星点淡入淡出
+  FADE_ALL = FADE_IN | FADE_OUT | FADE_WAKE | FADE_STAR
+};
 
 class LEDController
 {
@@ -9,7 +22,6 @@ private:
     // 私有成员变量
     WebServer server;
     bool currentMotionState;
-    unsigned long previousMillis;
     uint16_t breatheStep;
     uint8_t startHue;
     uint8_t ringHue;
@@ -18,6 +30,20 @@ private:
     uint8_t manualRed;
     uint8_t manualGreen; 
     uint8_t manualBlue;
+    LightMode currentMode;
+    bool timelineUploadOk;
+    bool showPending;
+    Phase phase;
+    bool autoMode;               // 与阶段正交的自动模式标志
+    EasingCurve fadeInCurve;
+    EasingCurve fadeOutCurve;
+    uint32_t stateVersion;       // 状态内容每变化一次加一，作为ETag
+    uint32_t statusCacheVersion;
+    uint32_t rootCacheVersion;
+    size_t statusLength;
+    unsigned long lastControlApply;
+    char statusCache[256];       // 缓存的/status响应
+    String rootCache;            // 缓存的首页
     CRGB mainLeds[Config::MAIN_NUM_LEDS];
     CRGB ringLeds[Config::RING_NUM_LEDS];
 
@@ -26,32 +52,74 @@ private:
     bool fadeOut();
     bool fadeIn();
     void setManualColor(uint8_t r, uint8_t g, uint8_t b);
+    void saveSettings();
+    void drainCommands();
+    void applyLatestControls(bool frame);
+    uint16_t controlFps() const;
+    void applyMotion(bool detected);
+    void dispatch(Event event);
+    void enterPhase(Phase p);
+    void exitPhase(Phase p);
+    void renderPhase(bool streamFrame);
+    void touchState();
+    bool notModified(char prefix);
+    void renderStatus();
+    const char *statusLabel() const;
+    uint8_t effectHue() const;
+    String buildRootPage() const;
+    String buildControlJson(const String &status, const String &message, int brightnessPercent) const;
+    uint8_t fadeOutLevel(uint8_t start, uint32_t elapsed) const;
+    uint8_t fadeInLevel(uint8_t target, uint32_t elapsed) const;
 
 public:
-
-    SystemState currentState;
-    SystemState lastState;
     // 构造函数
     LEDController();
 
     // 公共接口
     void begin();
+    void beginServer();
     void setBrightness(uint8_t brightness);
     void setMode(const String &mode);
+    bool setMode(LightMode mode);
+    void setFadeCurve(uint8_t slots, EasingCurve curve);
+    void requestShow();
     void update();
     void handleClient();
     void quickTestLeds();
+    uint32_t getFrameCount() const;
+
+    // 设置持久化
+    void applySettings(const LightSettings &settings);
+    LightSettings currentSettings() const;
+    void restoreMode();
+    static const char *modeName(LightMode mode);
+    static bool parseMode(const String &name, LightMode &mode);
 
     // 网页处理函数
     void handleRoot();
+    void handleStatus();
     void handleControl();
     void handleNotFound();
+    void handleTimelineUpload();
+    void handleTimelineUploadDone();
+    void handleTimelineStats();
+    void handleStreamStats();
+    void handleSyncStatus();
+    void handleMetrics();
+    void handleProfile();
+    void handleBench();
+    void handleCircadian();
+    void handleSchedule();
+    void handleSegments();
+    void handleLayers();
+    void handleStress();
+    void handleRender();
+    void handlePreview();
+    void handlePreviewStats();
 
     //处理跨文件资源访问
-    SystemState getState() const;
-    void setState(SystemState NewState);
-    void setBreathStep(uint16_t NewBreathStep);
-    void setStartHue(uint8_t hue);
+    Phase getPhase() const;
+    bool isAuto() const;
 };
 
 // 全局实例声明
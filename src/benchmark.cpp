@@ -0,0 +1,41 @@
+#include "benchmark.h"
+#include "text_util.h"
+#include <stdio.h>
+
+static unsigned long cyclesToNs(uint64_t c)
+{
+  return (unsigned long)(c * 1000 / LoopProfiler::cyclesPerUs());
+}
+
+BenchmarkSuite::BenchmarkSuite()
+    : count(0)
+{
+}
+
+uint8_t BenchmarkSuite::getCount() const
+{
+  return count;
+}
+
+const BenchmarkSuite::Result &BenchmarkSuite::getResult(uint8_t index) const
+{
+  return results[index];
+}
+
+size_t BenchmarkSuite::render(char *out, size_t cap) const
+{
+  size_t used = 0;
+  used = appendf(out, cap, used, "{\"build\":\"%s %s\",\"cyclesPerUs\":%lu,\"results\":[",
+                 __DATE__, __TIME__, (unsigned long)LoopProfiler::cyclesPerUs());
+  for (uint8_t i = 0; i < count; i++)
+  {
+    const Result &r = results[i];
+    used = appendf(out, cap, used,
+                   "%s{\"name\":\"%s\",\"iterations\":%lu,\"avgNs\":%lu,\"minNs\":%lu,\"maxNs\":%lu}",
+                   i ? "," : "", r.name, (unsigned long)r.iterations,
+                   cyclesToNs(r.iterations ? r.totalCycles / r.iterations : 0),
+                   cyclesToNs(r.minCycles), cyclesToNs(r.maxCycles));
+  }
+  used = appendf(out, cap, used, "]}");
+  return used;
+}
@@ -0,0 +1,60 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "loop_profiler.h"
+
+// 内核微基准：逐次计时，结果输出为JSON，便于不同提交之间对比
+class BenchmarkSuite
+{
+public:
+  static const uint8_t MAX_RESULTS = 24;
+
+  struct Result
+  {
+    const char *name;
+    uint32_t iterations;
+    uint64_t totalCycles;
+    uint32_t minCycles;
+    uint32_t maxCycles;
+  };
+
+  BenchmarkSuite();
+
+  // 先预热一次，再执行iterations次，每次单独计时
+  template <typename Fn>
+  void run(const char *name, uint32_t iterations, Fn fn)
+  {
+    if (count >= MAX_RESULTS)
+      return;
+    fn();
+    Result &r = results[count++];
+    r.name = name;
+    r.iterations = iterations;
+    r.totalCycles = 0;
+    r.minCycles = UINT32_MAX;
+    r.maxCycles = 0;
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+      uint32_t start = LoopProfiler::cycles();
+      fn();
+      uint32_t elapsed = LoopProfiler::cycles() - start;
+      r.totalCycles += elapsed;
+      if (elapsed < r.minCycles)
+        r.minCycles = elapsed;
+      if (elapsed > r.maxCycles)
+        r.maxCycles = elapsed;
+    }
+  }
+
+  uint8_t getCount() const;
+  const Result &getResult(uint8_t index) const;
+  size_t render(char *out, size_t cap) const;
+
+private:
+  Result results[MAX_RESULTS];
+  uint8_t count;
+};
+
+#endif
@@ -0,0 +1,83 @@
+#include "binary_log.h"
+
+BinaryLog binaryLog;
+
+BinaryLog::BinaryLog()
+    : enabled(true),
+      dropped(0)
+{
+}
+
+// 串口输出放在核心0的低优先级任务，主循环只付出一次入队的代价
+void BinaryLog::begin()
+{
+  xTaskCreatePinnedToCore(drainTask, "binlog", 2048, this, 1, nullptr, 0);
+}
+
+void BinaryLog::write(BinlogId id, int32_t a0, int32_t a1, int32_t a2)
+{
+  if (!enabled)
+    return;
+
+  Record record;
+  record.timestamp = millis();
+  record.id = id;
+  record.argc = BINLOG_TABLE[id].argc;
+  record.args[0] = a0;
+  record.args[1] = a1;
+  record.args[2] = a2;
+  if (!queue.push(record))
+    dropped++;
+}
+
+void BinaryLog::setEnabled(bool on)
+{
+  enabled = on;
+}
+
+bool BinaryLog::isEnabled() const
+{
+  return enabled;
+}
+
+uint32_t BinaryLog::getDropped() const
+{
+  return dropped;
+}
+
+void BinaryLog::drainTask(void *arg)
+{
+  static_cast<BinaryLog *>(arg)->drain();
+}
+
+void BinaryLog::drain()
+{
+  uint8_t frame[BINLOG_HEADER_SIZE + BINLOG_MAX_ARGS * 4];
+  Record record;
+
+  for (;;)
+  {
+    if (!queue.pop(record))
+    {
+      vTaskDelay(pdMS_TO_TICKS(10));
+      continue;
+    }
+
+    frame[0] = BINLOG_SYNC0;
+    frame[1] = BINLOG_SYNC1;
+    memcpy(frame + 2, &record.timestamp, 4);
+    memcpy(frame + 6, &record.id, 2);
+    frame[8] = record.argc;
+    uint8_t checksum = 0;
+    for (uint8_t i = 0; i < 9; i++)
+      checksum ^= frame[i];
+    frame[9] = checksum;
+    size_t length = BINLOG_HEADER_SIZE + record.argc * 4;
+    memcpy(frame + BINLOG_HEADER_SIZE, record.args, record.argc * 4);
+
+    // 串口发送缓冲不足时让出CPU，不在主循环里等待
+    while (Serial.availableForWrite() < (int)length)
+      vTaskDelay(1);
+    Serial.write(frame, length);
+  }
+}
@@ -0,0 +1,50 @@
+#ifndef BINARY_LOG_H
+#define BINARY_LOG_H
+
+#include <Arduino.h>
+#include "log_ids.h"
+#include "command_queue.h"
+
+// 编译期日志级别，低于该级别的BINLOG调用整个被编译器删除
+#ifndef BINLOG_LEVEL
+#define BINLOG_LEVEL BINLOG_LEVEL_INFO
+#endif
+
+// 热路径日志：只把编号和参数写入内存环形缓冲，由低优先级任务串口输出
+#define BINLOG(name, ...)                                              \
+  do                                                                   \
+  {                                                                    \
+    if (BINLOG_TABLE[LOGID_##name].level >= BINLOG_LEVEL)              \
+      binaryLog.write(LOGID_##name, ##__VA_ARGS__);                    \
+  } while (0)
+
+class BinaryLog
+{
+public:
+  BinaryLog();
+  void begin();
+  void write(BinlogId id, int32_t a0 = 0, int32_t a1 = 0, int32_t a2 = 0);
+  void setEnabled(bool on);
+  bool isEnabled() const;
+  uint32_t getDropped() const;
+
+private:
+  struct Record
+  {
+    uint32_t timestamp;
+    uint16_t id;
+    uint8_t argc;
+    int32_t args[BINLOG_MAX_ARGS];
+  };
+
+  MpscQueue<Record, 64> queue;
+  volatile bool enabled;
+  volatile uint32_t dropped;   // 缓冲满时丢弃的条数
+
+  static void drainTask(void *arg);
+  void drain();
+};
+
+extern BinaryLog binaryLog;
+
+#endif
@@ -0,0 +1,258 @@
+#include "circadian.h"
+#include <time.h>
+
+// 设备端：SNTP校时后的本地时间，时区由Config给出
+class SntpClock : public ClockSource
+{
+public:
+    bool valid() override
+    {
+        // 未校时前系统时间从1970年开始
+        return time(nullptr) > 1700000000;
+    }
+
+    uint32_t secondsOfDay() override
+    {
+        time_t now = time(nullptr);
+        struct tm local;
+        localtime_r(&now, &local);
+        return local.tm_hour * 3600UL + local.tm_min * 60UL + local.tm_sec;
+    }
+};
+
+static SntpClock sntpClock;
+
+CircadianEngine circadian;
+
+// 默认曲线：夜间低色温低亮度，上午升到冷白，傍晚逐渐回暖
+static const CircadianEngine::Point DEFAULT_CURVE[] = {
+    {0, 1900, 25},
+    {6 * 60, 2200, 40},
+    {8 * 60, 3500, 85},
+    {12 * 60, 5000, 100},
+    {17 * 60, 4000, 90},
+    {20 * 60, 2700, 60},
+    {22 * 60, 2200, 40},
+};
+
+ManualClock::ManualClock()
+    : isSet(false),
+      baseSeconds(0),
+      setAt(0)
+{
+}
+
+void ManualClock::set(uint32_t secondsOfDay)
+{
+    baseSeconds = secondsOfDay % 86400;
+    setAt = millis();
+    isSet = true;
+}
+
+bool ManualClock::valid()
+{
+    return isSet;
+}
+
+uint32_t ManualClock::secondsOfDay()
+{
+    return (baseSeconds + (millis() - setAt) / 1000) % 86400;
+}
+
+CircadianEngine::CircadianEngine()
+    : clock(&sntpClock),
+      pointCount(0),
+      valid(false),
+      pinned(false),
+      pinnedSeconds(0),
+      seconds(0),
+      kelvin(Config::CIRCADIAN_FALLBACK_K),
+      scale(255),
+      color(CRGB::Black),
+      lastUpdate(0),
+      clockEpoch(0)
+{
+    setCurve(DEFAULT_CURVE, sizeof(DEFAULT_CURVE) / sizeof(DEFAULT_CURVE[0]));
+}
+
+void CircadianEngine::begin()
+{
+    configTzTime(Config::timezone(), Config::ntpServer(), Config::ntpServerBackup());
+    recompute();
+}
+
+void CircadianEngine::loop()
+{
+    if (millis() - lastUpdate >= 1000)
+        recompute();
+}
+
+// 曲线必须非空、分钟严格递增且各值在范围内，否则保持原曲线
+bool CircadianEngine::setCurve(const Point *points, uint8_t count)
+{
+    if (count == 0 || count > MAX_POINTS)
+        return false;
+    for (uint8_t i = 0; i < count; i++)
+    {
+        if (points[i].minute >= 24 * 60 || points[i].percent > 100 ||
+            points[i].kelvin < kelvin_detail::MIN_K || points[i].kelvin > kelvin_detail::MAX_K)
+            return false;
+        if (i > 0 && points[i].minute <= points[i - 1].minute)
+            return false;
+    }
+    memcpy(curve, points, count * sizeof(Point));
+    pointCount = count;
+    recompute();
+    return true;
+}
+
+bool CircadianEngine::parseCurve(const String &text)
+{
+    Point points[MAX_POINTS];
+    uint8_t count = 0;
+    const char *p = text.c_str();
+    while (*p)
+    {
+        unsigned minute, k, percent;
+        int used = 0;
+        if (count >= MAX_POINTS || sscanf(p, "%u,%u,%u%n", &minute, &k, &percent, &used) != 3)
+            return false;
+        if (minute >= 24 * 60 || k > kelvin_detail::MAX_K || percent > 100)
+            return false;
+        points[count++] = Point{(uint16_t)minute, (uint16_t)k, (uint8_t)percent};
+        p += used;
+        if (*p == ';')
+            p++;
+        else if (*p)
+            return false;
+    }
+    return setCurve(points, count);
+}
+
+String CircadianEngine::curveString() const
+{
+    String text;
+    for (uint8_t i = 0; i < pointCount; i++)
+    {
+        if (i > 0)
+            text += ';';
+        text += String(curve[i].minute) + "," + String(curve[i].kelvin) + "," + String(curve[i].percent);
+    }
+    return text;
+}
+
+void CircadianEngine::setManualTime(uint32_t secondsOfDay)
+{
+    manualClock.set(secondsOfDay);
+    clock = &manualClock;
+    clockEpoch++;
+    recompute();
+}
+
+void CircadianEngine::useSntp()
+{
+    clock = &sntpClock;
+    clockEpoch++;
+    recompute();
+}
+
+// 固定期间颜色只取决于曲线和给定时刻；时间来源和校时状态照常跟踪，日程不受影响
+void CircadianEngine::pin(uint32_t secondsOfDay)
+{
+    pinned = true;
+    pinnedSeconds = secondsOfDay % 86400;
+    recompute();
+}
+
+void CircadianEngine::unpin()
+{
+    pinned = false;
+    recompute();
+}
+
+bool CircadianEngine::isManual() const
+{
+    return clock == &manualClock;
+}
+
+bool CircadianEngine::clockValid() const
+{
+    return valid;
+}
+
+uint32_t CircadianEngine::getSecondsOfDay() const
+{
+    return seconds;
+}
+
+uint16_t CircadianEngine::getKelvin() const
+{
+    return kelvin;
+}
+
+uint8_t CircadianEngine::getScale() const
+{
+    return scale;
+}
+
+ClockSource *CircadianEngine::getClock() const
+{
+    return clock;
+}
+
+uint16_t CircadianEngine::getClockEpoch() const
+{
+    return clockEpoch;
+}
+
+// 每帧调用：不带偏移时直接用缓存颜色，带偏移时多一次查表插值
+CRGB CircadianEngine::warmWhite(uint8_t value, int16_t kelvinOffset) const
+{
+    CRGB c = color;
+    if (kelvinOffset != 0)
+    {
+        kelvin_detail::Rgb8 rgb = kelvinToRgb((uint16_t)constrain((int32_t)kelvin + kelvinOffset, 0, 65535));
+        c = CRGB(rgb.r, rgb.g, rgb.b);
+    }
+    c.nscale8_video(scale8_video(value, scale));
+    return c;
+}
+
+// 找到当前时刻所在的曲线区间并线性插值；最后一点与第一点跨零点衔接
+void CircadianEngine::recompute()
+{
+    lastUpdate = millis();
+    bool nowValid = clock->valid();
+    if (nowValid != valid)
+        clockEpoch++;
+    valid = nowValid;
+    if (!valid && !pinned)
+    {
+        kelvin = Config::CIRCADIAN_FALLBACK_K;
+        scale = 255;
+    }
+    else
+    {
+        seconds = pinned ? pinnedSeconds : clock->secondsOfDay();
+        uint8_t i = pointCount - 1;
+        for (uint8_t n = 0; n < pointCount; n++)
+        {
+            if (curve[n].minute * 60UL <= seconds)
+                i = n;
+        }
+        const Point &a = curve[i];
+        const Point &b = curve[(i + 1) % pointCount];
+        uint32_t start = a.minute * 60UL;
+        uint32_t end = b.minute * 60UL;
+        if (end <= start)
+            end += 86400;
+        uint32_t t = seconds >= start ? seconds : seconds + 86400;
+        int32_t frac = (int32_t)((uint64_t)(t - start) * 256 / (end - start));
+
+        kelvin = a.kelvin + ((int32_t)b.kelvin - a.kelvin) * frac / 256;
+        int32_t percent = a.percent + ((int32_t)b.percent - a.percent) * frac / 256;
+        scale = percent * 255 / 100;
+    }
+    kelvin_detail::Rgb8 rgb = kelvinToRgb(kelvin);
+    color = CRGB(rgb.r, rgb.g, rgb.b);
+}
@@ -0,0 +1,88 @@
+#ifndef CIRCADIAN_H
+#define CIRCADIAN_H
+
+#include <Arduino.h>
+#include <FastLED.h>
+#include "config.h"
+#include "kelvin.h"
+
+// 本地时间来源抽象：设备上用SNTP，测试或未联网时用手动设定的替身
+class ClockSource
+{
+public:
+    virtual ~ClockSource() {}
+    virtual bool valid() = 0;
+    virtual uint32_t secondsOfDay() = 0;     // 当天第几秒（本地时间，0-86399）
+};
+
+// 手动时钟替身：设定一个时刻后随millis()走
+class ManualClock : public ClockSource
+{
+private:
+    bool isSet;
+    uint32_t baseSeconds;
+    unsigned long setAt;
+
+public:
+    ManualClock();
+    void set(uint32_t secondsOfDay);
+    bool valid() override;
+    uint32_t secondsOfDay() override;
+};
+
+// 昼夜节律：按一天中的时刻沿曲线插值出色温和亮度，暖白类效果都从这里取色
+class CircadianEngine
+{
+public:
+    // 曲线上的一个点：从minute起的色温和亮度百分比，点按minute递增，首尾循环衔接
+    struct Point
+    {
+        uint16_t minute;
+        uint16_t kelvin;
+        uint8_t percent;
+    };
+
+    static const uint8_t MAX_POINTS = 12;
+
+    CircadianEngine();
+    void begin();                                  // 启动SNTP
+    void loop();                                   // 每秒最多重算一次
+    bool setCurve(const Point *points, uint8_t count);
+    bool parseCurve(const String &text);           // "分钟,色温,百分比;..."
+    String curveString() const;
+    void setManualTime(uint32_t secondsOfDay);     // 切到手动时钟（调试/演示用）
+    void useSntp();
+    void pin(uint32_t secondsOfDay);               // 固定曲线输入的时刻（离线渲染用），不切换时间来源
+    void unpin();
+    bool isManual() const;
+    bool clockValid() const;
+    uint32_t getSecondsOfDay() const;
+    uint16_t getKelvin() const;
+    uint8_t getScale() const;                      // 曲线亮度，0-255
+    ClockSource *getClock() const;                 // 当前使用的时间来源（日程共用）
+    uint16_t getClockEpoch() const;                // 时间来源切换或校时状态变化时加一
+
+    // 当前色温（可加偏移）下的颜色，亮度为value再乘曲线亮度
+    CRGB warmWhite(uint8_t value, int16_t kelvinOffset = 0) const;
+
+private:
+    ClockSource *clock;
+    ManualClock manualClock;
+    Point curve[MAX_POINTS];
+    uint8_t pointCount;
+    bool valid;
+    bool pinned;
+    uint32_t pinnedSeconds;
+    uint32_t seconds;
+    uint16_t kelvin;
+    uint8_t scale;
+    CRGB color;                  // kelvin对应的满亮度颜色
+    unsigned long lastUpdate;
+    uint16_t clockEpoch;
+
+    void recompute();
+};
+
+extern CircadianEngine circadian;
+
+#endif
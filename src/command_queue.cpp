@@ -0,0 +1,5 @@
+#include "command_queue.h"
+
+CommandQueue commandQueue;
+LatestValue brightnessSlot;
+LatestValue colorSlot;
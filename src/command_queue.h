@@ -0,0 +1,133 @@
+#ifndef COMMAND_QUEUE_H
+#define COMMAND_QUEUE_H
+
+#include <Arduino.h>
+#include <atomic>
+
+// 外部输入（网页、人体传感器等）统一封装成命令，由update()每帧取出执行
+enum CommandType : uint8_t
+{
+  CMD_SET_MODE,       // arg0: LightMode
+  CMD_SET_BRIGHTNESS, // arg0: 0-255
+  CMD_SET_COLOR,      // arg0..2: r, g, b
+  CMD_MOTION,         // arg0: 是否有人
+  CMD_SET_CURVE,      // arg0: FadeSlot位掩码, arg1: EasingCurve
+  CMD_STOP            // 中止当前内容并淡出，无参数
+};
+
+struct Command
+{
+  CommandType type;
+  uint8_t arg0;
+  uint8_t arg1;
+  uint8_t arg2;
+};
+
+// 有界无锁多生产者单消费者队列（Vyukov算法）
+// 生产者可在任意任务/核心上push，只有主循环pop
+template <typename T, size_t N>
+class MpscQueue
+{
+  static_assert(N >= 2 && (N & (N - 1)) == 0, "容量必须是2的幂");
+
+public:
+  MpscQueue()
+      : enqueuePos(0),
+        dequeuePos(0)
+  {
+    for (size_t i = 0; i < N; i++)
+      cells[i].sequence.store(i, std::memory_order_relaxed);
+  }
+
+  // 队列满时返回false，不阻塞
+  bool push(const T &value)
+  {
+    uint32_t pos = enqueuePos.load(std::memory_order_relaxed);
+    Cell *cell;
+    for (;;)
+    {
+      cell = &cells[pos & (N - 1)];
+      uint32_t seq = cell->sequence.load(std::memory_order_acquire);
+      int32_t diff = (int32_t)(seq - pos);
+      if (diff == 0)
+      {
+        if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+          break;
+      }
+      else if (diff < 0)
+      {
+        return false;
+      }
+      else
+      {
+        pos = enqueuePos.load(std::memory_order_relaxed);
+      }
+    }
+    cell->value = value;
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  // 仅限单一消费者调用
+  bool pop(T &out)
+  {
+    Cell *cell = &cells[dequeuePos & (N - 1)];
+    uint32_t seq = cell->sequence.load(std::memory_order_acquire);
+    if ((int32_t)(seq - (dequeuePos + 1)) < 0)
+      return false;
+    out = cell->value;
+    cell->sequence.store(dequeuePos + N, std::memory_order_release);
+    dequeuePos++;
+    return true;
+  }
+
+private:
+  struct Cell
+  {
+    std::atomic<uint32_t> sequence;
+    T value;
+  };
+
+  Cell cells[N];
+  std::atomic<uint32_t> enqueuePos;
+  uint32_t dequeuePos;
+};
+
+typedef MpscQueue<Command, 32> CommandQueue;
+
+// 最新值槽：只保留最后一次写入的值，由update()每帧取一次
+// 用于滑块、取色器这类高频且只关心终值的输入，中间值被直接覆盖而不进队列
+class LatestValue
+{
+public:
+  LatestValue()
+      : slot(0)
+  {
+  }
+
+  // value不超过31位；返回true表示覆盖了一个尚未被取走的旧值
+  bool post(uint32_t value)
+  {
+    return slot.exchange(value | PENDING, std::memory_order_acq_rel) & PENDING;
+  }
+
+  // 仅限主循环调用
+  bool take(uint32_t &out)
+  {
+    uint32_t value = slot.exchange(0, std::memory_order_acq_rel);
+    if (!(value & PENDING))
+      return false;
+    out = value & ~PENDING;
+    return true;
+  }
+
+private:
+  static const uint32_t PENDING = 0x80000000u;
+  std::atomic<uint32_t> slot;
+};
+
+extern CommandQueue commandQueue;
+extern LatestValue brightnessSlot;   // 0-255
+extern LatestValue colorSlot;        // 0xRRGGBB
+
+#endif
@@ -5,6 +5,7 @@
 #include <WiFi.h>
 #include <WebServer.h>
 #include <Arduino.h>
+#include "light_mode.h"
 
 class Config
 {
@@ -18,6 +19,39 @@ public:
   static IPAddress gateway() { return IPAddress(192, 168, 31, 1); }
   static IPAddress subnet() { return IPAddress(255, 255, 255, 0); }
   static uint16_t serverPort() { return 80; }
+  static constexpr unsigned long WIFI_CONNECT_TIMEOUT_MS = 15000; // 单次连接超时
+  static constexpr unsigned long WIFI_RETRY_BASE_MS = 2000;       // 重连退避步长
+  static constexpr unsigned long WIFI_RETRY_MAX_MS = 30000;       // 重连退避上限
+
+  // 像素流（DDP）
+  static constexpr uint16_t DDP_PORT = 4048;
+  static constexpr unsigned long STREAM_TIMEOUT_MS = 2500;       // 无数据多久退回原模式
+
+  // 实时预览：端口81上的长连接推送灯带内容，帧为差分+游程编码
+  static constexpr uint16_t PREVIEW_PORT = 81;
+  static constexpr uint8_t PREVIEW_FPS = 10;                     // 默认推送帧率，客户端可用 ?fps= 调整
+  static constexpr uint8_t PREVIEW_MAX_FPS = 30;
+  static constexpr unsigned long PREVIEW_REQUEST_TIMEOUT_MS = 2000; // 连接后多久内须发完请求头
+
+  // 离线渲染：导出分片进行，每次主循环最多占用RENDER_SLICE_US，帧数设上限避免长时间占用
+  static constexpr uint32_t RENDER_MAX_FRAMES = 3000;
+  static constexpr uint16_t RENDER_MAX_FPS = 200;
+  static constexpr uint32_t RENDER_SLICE_US = 4000;
+
+  // 压力测试：模拟客户端经本机回环请求网页，人体传感器电平由测试翻转
+  static constexpr uint8_t STRESS_MAX_CLIENTS = 8;
+  static constexpr uint16_t STRESS_MAX_SECONDS = 60;             // 每个效果的最长测试时间
+  static constexpr uint32_t STRESS_JITTER_BUDGET_US = 4000;      // 帧间隔p99超出目标周期的上限
+  static constexpr uint16_t STRESS_PIR_TOGGLE_MS = 1500;
+
+  // 多控制器时间同步
+  static constexpr uint16_t TIME_SYNC_PORT = 4049;
+
+  // 昼夜节律（SNTP校时，时区为POSIX格式）
+  static const char *timezone() { return "CST-8"; }
+  static const char *ntpServer() { return "ntp.aliyun.com"; }
+  static const char *ntpServerBackup() { return "pool.ntp.org"; }
+  static constexpr uint16_t CIRCADIAN_FALLBACK_K = 2700;         // 未校时前使用的色温
 
   // 硬件引脚
   static constexpr int MAIN_LED_PIN = 19;
@@ -29,32 +63,43 @@ public:
   static constexpr int MAIN_NUM_LEDS = 60;
   static constexpr int RING_NUM_LEDS = 16;
 
+  // 灯具几何（毫米）：主灯带沿x轴从原点排布，灯环给出圆心、半径和0号灯珠方位（0度为+x，逆时针为正）
+  static constexpr double STRIP_LENGTH_MM = 1000.0;
+  static constexpr double RING_CENTER_X_MM = 500.0;
+  static constexpr double RING_CENTER_Y_MM = 150.0;
+  static constexpr double RING_RADIUS_MM = 60.0;
+  static constexpr double RING_START_DEG = 90.0;
+  static constexpr bool RING_CLOCKWISE = true;
+
   // 动画参数
   static constexpr uint16_t BREATHE_STEPS = 120;
   static constexpr uint16_t BREATHE_DURATION_MS = 1000;
   static constexpr uint16_t FADE_IN_MS = 800;
   static constexpr uint16_t FADE_OUT_MS = 1500;
-  static constexpr long NORMAL_UPDATE_INTERVAL = 30;
-};
+  static constexpr uint16_t RAINBOW_HUE_STEP_MS = 15;  // 彩虹色相每15ms前进1（原每30ms前进2）
 
-// 状态枚举
-enum SystemState
-{
-  STATE_AUTO_BREATH,
-  STATE_AUTO_FADE_IN,
-  STATE_AUTO_NORMAL,
-  STATE_AUTO_FADE_OUT,
-  STATE_AUTO_OFF,
-
-  // STATE_BREATHE_LOOP,
-  STATE_OFF,
-  STATE_BREATHE,
-  STATE_FADE_IN,
-  STATE_NORMAL,
-  STATE_FADE_OUT,
-  STATE_MANUAL,
-  
-  STATE_STARLIGHT_WAKEUP,
-  STATE_STARLIGHT_NORMAL
+  // 各效果目标帧率（帧调度器按此休眠）
+  static constexpr uint16_t BREATHE_FPS = BREATHE_STEPS * 1000 / BREATHE_DURATION_MS; // 每帧走一步
+  static constexpr uint16_t FADE_FPS = 60;
+  static constexpr uint16_t RAINBOW_FPS = 33;
+  static constexpr uint16_t STARLIGHT_FPS = 100;
+  static constexpr uint16_t TIMELINE_FPS = 33;
+  static constexpr uint16_t SEGMENTS_FPS = 50;
+  static constexpr uint16_t LAYERS_FPS = 50;
+  static constexpr uint16_t STREAM_CHECK_FPS = 10;  // 像素流到达即刷新，此帧率只用于检查超时
+  static constexpr uint16_t IDLE_POLL_MS = 2;       // 两帧之间最长休眠，保证网络轮询及时
+  static constexpr uint16_t CONTROL_APPLY_FPS = 30; // 静态画面下滑块/取色器的最高应用频率
+
+  // 自动模式熄灭后的低功耗待机
+  static constexpr unsigned long POWER_IDLE_DELAY_MS = 2000;  // 熄灭后多久进入待机
+  static constexpr uint32_t ACTIVE_CPU_MHZ = 240;
+  static constexpr uint32_t IDLE_CPU_MHZ = 80;                // WiFi运行时的最低主频
+  static constexpr uint16_t POWER_IDLE_POLL_MS = 20;          // 待机时网络轮询间隔
+  static constexpr uint32_t LIGHT_SLEEP_MAX_MS = 1000;        // WiFi离线时单次浅睡上限
+  static constexpr uint32_t WAKE_LATENCY_TARGET_MS = 50;      // 人体触发到首帧的目标延迟
+
+  // 设置持久化：最后一次修改后静默多久再写Flash
+  static constexpr unsigned long SETTINGS_SAVE_DELAY_MS = 3000;
 };
+
 #endif
\ No newline at end of file
@@ -0,0 +1,121 @@
+#ifndef CX_MATH_H
+#define CX_MATH_H
+
+// 编译期数学函数，只用于生成查找表，运行时不调用
+namespace cxmath
+{
+  constexpr double PI = 3.14159265358979323846;
+  constexpr double LN2 = 0.69314718055994530942;
+
+  // 先归约到[-PI, PI]，泰勒级数18项足够精确
+  constexpr double cos(double x)
+  {
+    while (x > PI)
+      x -= 2 * PI;
+    while (x < -PI)
+      x += 2 * PI;
+    double term = 1.0;
+    double sum = 1.0;
+    for (int n = 1; n < 18; n++)
+    {
+      term *= -x * x / ((2 * n - 1) * (2 * n));
+      sum += term;
+    }
+    return sum;
+  }
+
+  // 先把参数减半到|x|<0.5再展开，最后平方还原
+  constexpr double exp(double x)
+  {
+    int halvings = 0;
+    while (x > 0.5 || x < -0.5)
+    {
+      x /= 2;
+      halvings++;
+    }
+    double term = 1.0;
+    double sum = 1.0;
+    for (int n = 1; n < 14; n++)
+    {
+      term *= x / n;
+      sum += term;
+    }
+    while (halvings-- > 0)
+      sum *= sum;
+    return sum;
+  }
+
+  // x>0：先按2的幂归一到[0.5, 1)，再用 ln(m) = 2*atanh((m-1)/(m+1)) 展开
+  constexpr double log(double x)
+  {
+    int exponent = 0;
+    while (x >= 1.0)
+    {
+      x /= 2;
+      exponent++;
+    }
+    while (x < 0.5)
+    {
+      x *= 2;
+      exponent--;
+    }
+    double z = (x - 1.0) / (x + 1.0);
+    double z2 = z * z;
+    double term = z;
+    double sum = 0.0;
+    for (int n = 1; n < 40; n += 2)
+    {
+      sum += term / n;
+      term *= z2;
+    }
+    return 2.0 * sum + exponent * LN2;
+  }
+
+  constexpr double pow(double base, double exponent)
+  {
+    return base <= 0.0 ? 0.0 : exp(exponent * log(base));
+  }
+
+  constexpr double sin(double x)
+  {
+    return cos(x - PI / 2);
+  }
+
+  // 牛顿迭代，初值取max(x, 1)保证单调收敛
+  constexpr double sqrt(double x)
+  {
+    if (x <= 0.0)
+      return 0.0;
+    double g = x > 1.0 ? x : 1.0;
+    for (int i = 0; i < 64; i++)
+      g = 0.5 * (g + x / g);
+    return g;
+  }
+
+  // 用 atan(z) = 2*atan(z/(1+sqrt(1+z^2))) 折半三次到|z|<0.2，再用级数展开
+  constexpr double atan(double z)
+  {
+    for (int i = 0; i < 3; i++)
+      z = z / (1.0 + sqrt(1.0 + z * z));
+    double z2 = z * z;
+    double term = z;
+    double sum = 0.0;
+    for (int n = 1; n < 30; n += 2)
+    {
+      sum += term / n;
+      term *= -z2;
+    }
+    return 8.0 * sum;
+  }
+
+  constexpr double atan2(double y, double x)
+  {
+    if (x > 0.0)
+      return atan(y / x);
+    if (x < 0.0)
+      return y >= 0.0 ? atan(y / x) + PI : atan(y / x) - PI;
+    return y > 0.0 ? PI / 2 : y < 0.0 ? -PI / 2 : 0.0;
+  }
+}
+
+#endif
@@ -0,0 +1,134 @@
+#include "ddp_receiver.h"
+#include "wifi_manager.h"
+
+DdpReceiver ddpReceiver;
+
+static const uint32_t MAIN_BYTES = Config::MAIN_NUM_LEDS * 3;
+static const uint32_t RING_BYTES = Config::RING_NUM_LEDS * 3;
+
+DdpReceiver::DdpReceiver()
+    : mainLeds(nullptr),
+      ringLeds(nullptr),
+      listening(false),
+      lastSeq(0),
+      lastPacket(0)
+{
+  memset(&stats, 0, sizeof(stats));
+}
+
+void DdpReceiver::begin(CRGB *main, CRGB *ring)
+{
+  mainLeds = main;
+  ringLeds = ring;
+}
+
+bool DdpReceiver::isActive() const
+{
+  return stats.packets > 0 && millis() - lastPacket < Config::STREAM_TIMEOUT_MS;
+}
+
+unsigned long DdpReceiver::lastPacketMs() const
+{
+  return lastPacket;
+}
+
+const DdpReceiver::Stats &DdpReceiver::getStats() const
+{
+  return stats;
+}
+
+// DDP序号1..15循环，0表示发送端不使用序号
+void DdpReceiver::trackSequence(uint8_t seq)
+{
+  if (seq == 0)
+    return;
+  if (lastSeq != 0)
+  {
+    uint8_t expected = lastSeq % 15 + 1;
+    if (seq != expected)
+    {
+      uint8_t gap = (seq + 15 - expected) % 15;
+      if (gap < 8)
+        stats.lost += gap;
+      else
+        stats.outOfOrder++;
+    }
+  }
+  lastSeq = seq;
+}
+
+// 把包内[offset, offset+length)范围直接读入对应灯带内存，返回已读取字节数
+uint32_t DdpReceiver::readInto(uint32_t offset, uint32_t length)
+{
+  uint32_t consumed = 0;
+  uint32_t end = offset + length;
+
+  if (offset < MAIN_BYTES)
+  {
+    uint32_t n = min(end, MAIN_BYTES) - offset;
+    consumed += udp.read((uint8_t *)mainLeds + offset, n);
+    offset += n;
+  }
+  if (offset >= MAIN_BYTES && offset < MAIN_BYTES + RING_BYTES && offset < end)
+  {
+    uint32_t n = min(end, MAIN_BYTES + RING_BYTES) - offset;
+    consumed += udp.read((uint8_t *)ringLeds + (offset - MAIN_BYTES), n);
+  }
+  return consumed;
+}
+
+bool DdpReceiver::poll()
+{
+  if (!listening)
+  {
+    if (!wifiManager.isConnected())
+      return false;
+    listening = udp.begin(Config::DDP_PORT);
+    if (!listening)
+      return false;
+    Serial.print("DDP监听端口: ");
+    Serial.println(Config::DDP_PORT);
+  }
+
+  bool framePushed = false;
+  // 一次最多处理若干包，避免大量积压时阻塞主循环
+  for (uint8_t i = 0; i < 8; i++)
+  {
+    int size = udp.parsePacket();
+    if (size <= 0)
+      break;
+
+    uint8_t header[HEADER_SIZE];
+    if (size < HEADER_SIZE || udp.read(header, HEADER_SIZE) != HEADER_SIZE ||
+        (header[0] & FLAG_VERSION_MASK) != FLAG_VERSION_1 || (header[0] & FLAG_QUERY))
+    {
+      stats.malformed++;
+      udp.flush();
+      continue;
+    }
+
+    if (header[0] & FLAG_TIMECODE)
+    {
+      uint8_t timecode[4];
+      udp.read(timecode, sizeof(timecode));
+    }
+
+    uint32_t offset = ((uint32_t)header[4] << 24) | ((uint32_t)header[5] << 16) |
+                      ((uint32_t)header[6] << 8) | header[7];
+    uint32_t length = ((uint32_t)header[8] << 8) | header[9];
+
+    trackSequence(header[1] & 0x0F);
+    stats.packets++;
+    lastPacket = millis();
+
+    readInto(offset, length);
+    udp.flush();
+
+    if (header[0] & FLAG_PUSH)
+    {
+      stats.frames++;
+      framePushed = true;
+    }
+  }
+  return framePushed;
+}
@@ -0,0 +1,51 @@
+#ifndef DDP_RECEIVER_H
+#define DDP_RECEIVER_H
+
+#include <Arduino.h>
+#include <WiFiUdp.h>
+#include "config.h"
+
+// DDP像素流接收：包数据直接从UDP缓冲读入mainLeds/ringLeds
+// 字节偏移 0..MAIN*3-1 对应主灯带，其后对应灯环，顺序RGB
+class DdpReceiver
+{
+public:
+    struct Stats
+    {
+        uint32_t packets;
+        uint32_t frames;        // 收到PUSH标志的次数
+        uint32_t lost;          // 序号跳变推算出的丢包
+        uint32_t outOfOrder;
+        uint32_t malformed;
+    };
+
+    DdpReceiver();
+    void begin(CRGB *main, CRGB *ring);
+    bool poll();                // 有完整帧（PUSH）可显示时返回true
+    bool isActive() const;      // 超时前一直视为活跃
+    unsigned long lastPacketMs() const;
+    const Stats &getStats() const;
+
+private:
+    static const uint8_t HEADER_SIZE = 10;
+    static const uint8_t FLAG_VERSION_MASK = 0xC0;
+    static const uint8_t FLAG_VERSION_1 = 0x40;
+    static const uint8_t FLAG_TIMECODE = 0x10;
+    static const uint8_t FLAG_QUERY = 0x02;
+    static const uint8_t FLAG_PUSH = 0x01;
+
+    WiFiUDP udp;
+    CRGB *mainLeds;
+    CRGB *ringLeds;
+    bool listening;
+    uint8_t lastSeq;
+    unsigned long lastPacket;
+    Stats stats;
+
+    void trackSequence(uint8_t seq);
+    uint32_t readInto(uint32_t offset, uint32_t length);
+};
+
+extern DdpReceiver ddpReceiver;
+
+#endif
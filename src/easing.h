@@ -0,0 +1,154 @@
+#ifndef EASING_H
+#define EASING_H
+
+#include <stdint.h>
+#include "cx_math.h"
+
+/*
+缓动曲线库：所有曲线在编译期生成为256项查找表（存放在Flash），
+运行时一次查表即可，配合Progress8把每帧的除法换成乘法和移位。
+*/
+
+enum EasingCurve : uint8_t
+{
+  CURVE_LINEAR,
+  CURVE_IN_QUAD,
+  CURVE_OUT_QUAD,
+  CURVE_IN_OUT_QUAD,
+  CURVE_SINE,       // 正弦缓入缓出
+  CURVE_EXPO,       // 指数缓入，低亮度段变化更细
+  CURVE_CIE,        // CIE 1976明度，人眼感知上均匀
+  CURVE_COUNT
+};
+
+constexpr const char *CURVE_NAMES[CURVE_COUNT] = {
+    "linear", "in", "out", "in_out", "sine", "expo", "cie"};
+
+namespace easing_detail
+{
+  // 明度L*(0-100) -> 相对亮度Y(0-1)
+  constexpr double cieLightness(double l)
+  {
+    if (l <= 8.0)
+      return l / 903.3;
+    double f = (l + 16.0) / 116.0;
+    return f * f * f;
+  }
+
+  constexpr double curveValue(uint8_t curve, double t)
+  {
+    switch (curve)
+    {
+    case CURVE_IN_QUAD:
+      return t * t;
+    case CURVE_OUT_QUAD:
+      return 1.0 - (1.0 - t) * (1.0 - t);
+    case CURVE_IN_OUT_QUAD:
+      return t < 0.5 ? 2 * t * t : 1.0 - 2 * (1.0 - t) * (1.0 - t);
+    case CURVE_SINE:
+      return 0.5 - 0.5 * cxmath::cos(cxmath::PI * t);
+    case CURVE_EXPO:
+      return t <= 0.0 ? 0.0 : cxmath::exp((10.0 * t - 10.0) * cxmath::LN2);
+    case CURVE_CIE:
+      return cieLightness(100.0 * t);
+    default:
+      return t;
+    }
+  }
+
+  struct EasingTables
+  {
+    uint8_t table[CURVE_COUNT][256];
+  };
+
+  constexpr EasingTables buildTables()
+  {
+    EasingTables tables{};
+    for (uint8_t c = 0; c < CURVE_COUNT; c++)
+    {
+      for (int i = 0; i < 256; i++)
+      {
+        double v = curveValue(c, i / 255.0) * 255.0 + 0.5;
+        tables.table[c][i] = v <= 0 ? 0 : v >= 255 ? 255 : (uint8_t)v;
+      }
+    }
+    return tables;
+  }
+
+  constexpr bool tablesValid(const EasingTables &tables)
+  {
+    for (uint8_t c = 0; c < CURVE_COUNT; c++)
+    {
+      if (tables.table[c][0] != 0 || tables.table[c][255] != 255)
+        return false;
+      for (int i = 1; i < 256; i++)
+        if (tables.table[c][i] < tables.table[c][i - 1])
+          return false;
+    }
+    return true;
+  }
+}
+
+inline constexpr easing_detail::EasingTables EASING_TABLES = easing_detail::buildTables();
+
+// 每条曲线都从0到255且单调不减
+static_assert(easing_detail::tablesValid(EASING_TABLES), "easing tables must be monotonic from 0 to 255");
+
+inline uint8_t ease8(EasingCurve curve, uint8_t progress)
+{
+  return EASING_TABLES.table[curve < CURVE_COUNT ? curve : CURVE_LINEAR][progress];
+}
+
+// value按缓动值缩放：eased为0时得0，为255时得value
+inline uint8_t easeScale(uint8_t value, uint8_t eased)
+{
+  return ((uint16_t)value * (eased + 1)) >> 8;
+}
+
+inline bool parseCurve(const char *name, EasingCurve &curve)
+{
+  for (uint8_t i = 0; i < CURVE_COUNT; i++)
+  {
+    const char *a = name;
+    const char *b = CURVE_NAMES[i];
+    while (*a && *a == *b)
+    {
+      a++;
+      b++;
+    }
+    if (*a == *b)
+    {
+      curve = (EasingCurve)i;
+      return true;
+    }
+  }
+  return false;
+}
+
+// 进度换算：时长确定时算一次倒数，之后每帧只做乘法和移位，得到0-255的进度
+class Progress8
+{
+public:
+  constexpr explicit Progress8(uint32_t durationMs = 1)
+      : duration(durationMs ? durationMs : 1),
+        reciprocal((256u << 16) / (durationMs ? durationMs : 1))
+  {
+  }
+
+  // elapsed < duration时 elapsed*reciprocal < 2^24，不会溢出
+  constexpr uint8_t at(uint32_t elapsed) const
+  {
+    return elapsed >= duration ? 255 : (uint8_t)((elapsed * reciprocal) >> 16);
+  }
+
+  constexpr uint32_t getDuration() const
+  {
+    return duration;
+  }
+
+private:
+  uint32_t duration;
+  uint32_t reciprocal;
+};
+
+#endif
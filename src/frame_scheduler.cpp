@@ -0,0 +1,161 @@
+#include "frame_scheduler.h"
+#include "config.h"
+
+FrameScheduler frameScheduler;
+
+FrameScheduler::FrameScheduler()
+    : loopTask(nullptr),
+      targetFps(FPS_STATIC),
+      intervalUs(0),
+      nextFrameUs(0),
+      idlePollMs(Config::IDLE_POLL_MS),
+      forceFrame(true),
+      frames(0),
+      misses(0),
+      eventWakeups(0),
+      windowStartUs(0),
+      windowFrames(0),
+      windowSleepUs(0),
+      achievedFps(0),
+      cpuLoad(100)
+{
+}
+
+void FrameScheduler::begin()
+{
+  loopTask = xTaskGetCurrentTaskHandle();
+  windowStartUs = micros();
+}
+
+void FrameScheduler::setTargetFps(uint16_t fps)
+{
+  targetFps = fps;
+  intervalUs = fps ? 1000000UL / fps : 0;
+  nextFrameUs = micros();
+  forceFrame = true;
+}
+
+void FrameScheduler::setIdlePollMs(uint16_t ms)
+{
+  idlePollMs = ms;
+}
+
+bool FrameScheduler::frameDue(bool event)
+{
+  uint32_t now = micros();
+  updateWindow(now);
+
+  bool due = event || forceFrame;
+  if (intervalUs && (int32_t)(now - nextFrameUs) >= 0)
+  {
+    // 落后一整帧以上时不追帧，从当前时刻重新对齐
+    if (now - nextFrameUs >= intervalUs)
+    {
+      misses++;
+      nextFrameUs = now + intervalUs;
+    }
+    else
+    {
+      nextFrameUs += intervalUs;
+    }
+    due = true;
+  }
+
+  if (due)
+  {
+    forceFrame = false;
+    frames++;
+    windowFrames++;
+  }
+  return due;
+}
+
+void FrameScheduler::idle()
+{
+  if (!loopTask || forceFrame)
+    return;
+
+  // 静态阶段也只睡一个轮询周期，保证网络请求和像素流的响应
+  uint32_t now = micros();
+  uint32_t sleepUs = idlePollMs * 1000UL;
+  if (intervalUs)
+  {
+    int32_t untilDeadline = (int32_t)(nextFrameUs - now);
+    if (untilDeadline <= 0)
+      return;
+    if ((uint32_t)untilDeadline < sleepUs)
+      sleepUs = untilDeadline;
+  }
+
+  // 不足一个tick时直接返回，下一轮再检查
+  TickType_t ticks = sleepUs / (portTICK_PERIOD_MS * 1000UL);
+  if (ticks == 0)
+    return;
+
+  if (ulTaskNotifyTake(pdTRUE, ticks) > 0)
+    eventWakeups++;
+  windowSleepUs += micros() - now;
+}
+
+void FrameScheduler::notify()
+{
+  if (loopTask)
+    xTaskNotifyGive(loopTask);
+}
+
+void IRAM_ATTR FrameScheduler::notifyFromISR()
+{
+  if (!loopTask)
+    return;
+  BaseType_t woken = pdFALSE;
+  vTaskNotifyGiveFromISR(loopTask, &woken);
+  portYIELD_FROM_ISR(woken);
+}
+
+void FrameScheduler::updateWindow(uint32_t nowUs)
+{
+  uint32_t elapsed = nowUs - windowStartUs;
+  if (elapsed < 1000000UL)
+    return;
+  achievedFps = (uint64_t)windowFrames * 1000000UL / elapsed;
+  uint32_t sleptPercent = (uint64_t)windowSleepUs * 100 / elapsed;
+  cpuLoad = sleptPercent >= 100 ? 0 : 100 - sleptPercent;
+  windowStartUs = nowUs;
+  windowFrames = 0;
+  windowSleepUs = 0;
+}
+
+FrameScheduler::Stats FrameScheduler::getStats() const
+{
+  Stats stats;
+  stats.targetFps = targetFps;
+  stats.achievedFps = achievedFps;
+  stats.cpuLoad = cpuLoad;
+  stats.frames = frames;
+  stats.misses = misses;
+  stats.eventWakeups = eventWakeups;
+  return stats;
+}
+
+size_t FrameScheduler::renderMetrics(char *out, size_t cap) const
+{
+  if (cap == 0)
+    return 0;
+  int n = snprintf(out, cap,
+                   "# HELP led_frame_target_fps Target frame rate of the current phase (0 = static).\n"
+                   "# TYPE led_frame_target_fps gauge\n"
+                   "led_frame_target_fps %u\n"
+                   "# HELP led_frame_achieved_fps Frames rendered in the last second.\n"
+                   "# TYPE led_frame_achieved_fps gauge\n"
+                   "led_frame_achieved_fps %u\n"
+                   "# HELP led_frame_deadline_misses_total Frames late by more than one interval.\n"
+                   "# TYPE led_frame_deadline_misses_total counter\n"
+                   "led_frame_deadline_misses_total %lu\n"
+                   "# HELP led_loop_cpu_load_percent Share of the last second the loop task was awake.\n"
+                   "# TYPE led_loop_cpu_load_percent gauge\n"
+                   "led_loop_cpu_load_percent %u\n",
+                   targetFps, achievedFps, (unsigned long)misses, cpuLoad);
+  if (n < 0)
+    return 0;
+  return (size_t)n < cap ? n : cap - 1;
+}
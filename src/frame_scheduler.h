@@ -0,0 +1,59 @@
+#ifndef FRAME_SCHEDULER_H
+#define FRAME_SCHEDULER_H
+
+#include <Arduino.h>
+
+// 帧调度：每个阶段声明目标帧率（0为静态，只在进入时渲染一次），
+// 两帧之间loop任务阻塞等待，到期或有输入事件（任务通知）时唤醒
+class FrameScheduler
+{
+public:
+  static const uint16_t FPS_STATIC = 0;
+
+  struct Stats
+  {
+    uint16_t targetFps;
+    uint16_t achievedFps;     // 最近一秒实际渲染帧数
+    uint8_t cpuLoad;          // 最近一秒loop任务未休眠的百分比
+    uint32_t frames;
+    uint32_t misses;          // 迟到超过一整帧的次数
+    uint32_t eventWakeups;    // 被输入事件提前唤醒的次数
+  };
+
+  FrameScheduler();
+
+  void begin();                      // 须在loop任务中调用，记录任务句柄
+  void setTargetFps(uint16_t fps);   // 切换后立即出一帧
+  void setIdlePollMs(uint16_t ms);   // 两帧之间的最长休眠
+  bool frameDue(bool event = false); // event为true时（如收到像素流）不等截止时间
+  void idle();                       // 休眠到下一帧截止或输入事件
+  void notify();
+  void notifyFromISR();
+
+  Stats getStats() const;
+  size_t renderMetrics(char *out, size_t cap) const;
+
+private:
+  TaskHandle_t loopTask;
+  uint16_t targetFps;
+  uint32_t intervalUs;
+  uint32_t nextFrameUs;
+  uint16_t idlePollMs;
+  bool forceFrame;
+  uint32_t frames;
+  uint32_t misses;
+  uint32_t eventWakeups;
+
+  // 一秒统计窗口
+  uint32_t windowStartUs;
+  uint32_t windowFrames;
+  uint32_t windowSleepUs;
+  uint16_t achievedFps;
+  uint8_t cpuLoad;
+
+  void updateWindow(uint32_t nowUs);
+};
+
+extern FrameScheduler frameScheduler;
+
+#endif
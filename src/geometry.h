@@ -0,0 +1,160 @@
+#ifndef GEOMETRY_H
+#define GEOMETRY_H
+
+#include <stdint.h>
+#include "config.h"
+#include "cx_math.h"
+
+/*
+灯具几何映射：每颗灯珠在整个灯具统一坐标系中的位置，编译期生成为定点查找表（存放在Flash）。
+直角坐标按灯具外接框等比缩放到0-255，极坐标以灯环圆心为原点。
+效果按空间位置编写一次即可同时用于主灯带和灯环，运行时只查表，不做三角运算。
+*/
+
+struct PixelCoord
+{
+  uint8_t x;        // 灯具最长方向铺满0-255
+  uint8_t y;
+  uint8_t angle;    // 绕灯环圆心的方位，256为一圈，0为+x方向，逆时针增加
+  uint8_t radius;   // 到灯环圆心的距离，最远的灯珠为255
+};
+
+namespace geometry_detail
+{
+  struct Point
+  {
+    double x;
+    double y;
+  };
+
+  struct Bounds
+  {
+    double minX;
+    double minY;
+    double extent;      // 外接框较长边，x和y共用，保持比例
+    double maxRadius;
+  };
+
+  struct GeometryMap
+  {
+    PixelCoord main[Config::MAIN_NUM_LEDS];
+    PixelCoord ring[Config::RING_NUM_LEDS];
+  };
+
+  constexpr int PIXELS = Config::MAIN_NUM_LEDS + Config::RING_NUM_LEDS;
+
+  constexpr double ringAngle(int i)
+  {
+    double step = 2 * cxmath::PI * i / Config::RING_NUM_LEDS;
+    return Config::RING_START_DEG * cxmath::PI / 180 + (Config::RING_CLOCKWISE ? -step : step);
+  }
+
+  // 像素编号：主灯带在前，灯环在后
+  constexpr Point pixelPoint(int i)
+  {
+    if (i < Config::MAIN_NUM_LEDS)
+      return Point{Config::STRIP_LENGTH_MM * i / (Config::MAIN_NUM_LEDS - 1), 0.0};
+    double a = ringAngle(i - Config::MAIN_NUM_LEDS);
+    return Point{Config::RING_CENTER_X_MM + Config::RING_RADIUS_MM * cxmath::cos(a),
+                 Config::RING_CENTER_Y_MM + Config::RING_RADIUS_MM * cxmath::sin(a)};
+  }
+
+  constexpr double distance(Point p)
+  {
+    double dx = p.x - Config::RING_CENTER_X_MM;
+    double dy = p.y - Config::RING_CENTER_Y_MM;
+    return cxmath::sqrt(dx * dx + dy * dy);
+  }
+
+  constexpr Bounds bounds()
+  {
+    Point first = pixelPoint(0);
+    double minX = first.x, maxX = first.x, minY = first.y, maxY = first.y, maxRadius = 0.0;
+    for (int i = 0; i < PIXELS; i++)
+    {
+      Point p = pixelPoint(i);
+      minX = p.x < minX ? p.x : minX;
+      maxX = p.x > maxX ? p.x : maxX;
+      minY = p.y < minY ? p.y : minY;
+      maxY = p.y > maxY ? p.y : maxY;
+      maxRadius = distance(p) > maxRadius ? distance(p) : maxRadius;
+    }
+    double extent = maxX - minX > maxY - minY ? maxX - minX : maxY - minY;
+    return Bounds{minX, minY, extent > 0.0 ? extent : 1.0, maxRadius > 0.0 ? maxRadius : 1.0};
+  }
+
+  constexpr uint8_t toByte(double v)
+  {
+    return v <= 0.0 ? 0 : v >= 255.0 ? 255 : (uint8_t)(v + 0.5);
+  }
+
+  // 弧度 -> 0-255，满一圈回到0
+  constexpr uint8_t toAngle(double a)
+  {
+    double turns = a / (2 * cxmath::PI);
+    turns -= (double)(long)turns;
+    if (turns < 0.0)
+      turns += 1.0;
+    return (uint8_t)((unsigned)(turns * 256 + 0.5) & 0xFF);
+  }
+
+  constexpr PixelCoord coord(int i, Bounds b)
+  {
+    Point p = pixelPoint(i);
+    return PixelCoord{toByte((p.x - b.minX) * 255 / b.extent),
+                      toByte((p.y - b.minY) * 255 / b.extent),
+                      toAngle(cxmath::atan2(p.y - Config::RING_CENTER_Y_MM, p.x - Config::RING_CENTER_X_MM)),
+                      toByte(distance(p) * 255 / b.maxRadius)};
+  }
+
+  constexpr GeometryMap buildMap()
+  {
+    GeometryMap map{};
+    Bounds b = bounds();
+    for (int i = 0; i < Config::MAIN_NUM_LEDS; i++)
+      map.main[i] = coord(i, b);
+    for (int i = 0; i < Config::RING_NUM_LEDS; i++)
+      map.ring[i] = coord(Config::MAIN_NUM_LEDS + i, b);
+    return map;
+  }
+
+  constexpr bool ringRadiusUniform(const GeometryMap &map)
+  {
+    for (int i = 1; i < Config::RING_NUM_LEDS; i++)
+      if (map.ring[i].radius != map.ring[0].radius)
+        return false;
+    return true;
+  }
+}
+
+inline constexpr geometry_detail::GeometryMap GEOMETRY = geometry_detail::buildMap();
+
+// 灯环上的灯珠到圆心距离相同，0号灯珠落在配置的方位上；布局参数或生成公式出错时编译失败
+static_assert(geometry_detail::ringRadiusUniform(GEOMETRY), "ring pixels should share one radius");
+static_assert(GEOMETRY.ring[0].angle == geometry_detail::toAngle(Config::RING_START_DEG * cxmath::PI / 180),
+              "ring pixel 0 should sit at RING_START_DEG");
+
+// 两个方位之间的最短角距离，0-128
+inline uint8_t angleDistance(uint8_t a, uint8_t b)
+{
+  int8_t d = (int8_t)(uint8_t)(a - b);
+  return d < 0 ? (uint8_t)(-d) : (uint8_t)d;
+}
+
+// 距离在width内线性衰减到0，用于软边光斑
+inline uint8_t falloff8(uint8_t distance, uint8_t width)
+{
+  return distance >= width ? 0 : 255 - (uint16_t)distance * 255 / width;
+}
+
+// 按坐标为主灯带和灯环的每颗灯珠调用 fn(const PixelCoord&) -> CRGB
+template <typename Fn>
+inline void renderSpatial(CRGB *main, CRGB *ring, Fn fn)
+{
+  for (uint8_t i = 0; i < Config::MAIN_NUM_LEDS; i++)
+    main[i] = fn(GEOMETRY.main[i]);
+  for (uint8_t i = 0; i < Config::RING_NUM_LEDS; i++)
+    ring[i] = fn(GEOMETRY.ring[i]);
+}
+
+#endif
@@ -0,0 +1,77 @@
+#ifndef KELVIN_H
+#define KELVIN_H
+
+#include <stdint.h>
+#include "cx_math.h"
+
+// 色温 -> RGB 查找表：1000K-10000K，每100K一项，编译期按 Tanner Helland 的黑体拟合公式生成
+namespace kelvin_detail
+{
+  constexpr uint16_t MIN_K = 1000;
+  constexpr uint16_t MAX_K = 10000;
+  constexpr uint16_t STEP_K = 100;
+  constexpr uint8_t ENTRIES = (MAX_K - MIN_K) / STEP_K + 1;
+
+  struct Rgb8
+  {
+    uint8_t r;
+    uint8_t g;
+    uint8_t b;
+  };
+
+  struct KelvinTable
+  {
+    Rgb8 rgb[ENTRIES];
+  };
+
+  constexpr uint8_t clamp8(double v)
+  {
+    return v <= 0.0 ? 0 : v >= 255.0 ? 255 : (uint8_t)(v + 0.5);
+  }
+
+  constexpr Rgb8 blackbody(double kelvin)
+  {
+    double t = kelvin / 100.0;
+    double r = t <= 66 ? 255.0 : 329.698727446 * cxmath::pow(t - 60, -0.1332047592);
+    double g = t <= 66 ? 99.4708025861 * cxmath::log(t) - 161.1195681661
+                       : 288.1221695283 * cxmath::pow(t - 60, -0.0755148492);
+    double b = t >= 66 ? 255.0 : t <= 19 ? 0.0 : 138.5177312231 * cxmath::log(t - 10) - 305.0447927307;
+    return Rgb8{clamp8(r), clamp8(g), clamp8(b)};
+  }
+
+  constexpr KelvinTable buildTable()
+  {
+    KelvinTable table{};
+    for (uint8_t i = 0; i < ENTRIES; i++)
+      table.rgb[i] = blackbody(MIN_K + i * STEP_K);
+    return table;
+  }
+}
+
+inline constexpr kelvin_detail::KelvinTable KELVIN_TABLE = kelvin_detail::buildTable();
+
+// 抽查表中几处已知值，生成公式出错时编译失败
+static_assert(KELVIN_TABLE.rgb[(6600 - 1000) / 100].r == 255 && KELVIN_TABLE.rgb[(6600 - 1000) / 100].b == 255,
+              "6600K should be close to white");
+static_assert(KELVIN_TABLE.rgb[(1900 - 1000) / 100].b == 0 && KELVIN_TABLE.rgb[0].r == 255,
+              "low colour temperatures should have no blue");
+
+// 查表并在相邻两项之间线性插值，超出范围时取端点
+inline kelvin_detail::Rgb8 kelvinToRgb(uint16_t kelvin)
+{
+  using namespace kelvin_detail;
+  if (kelvin <= MIN_K)
+    return KELVIN_TABLE.rgb[0];
+  if (kelvin >= MAX_K)
+    return KELVIN_TABLE.rgb[ENTRIES - 1];
+  uint16_t offset = kelvin - MIN_K;
+  uint8_t i = offset / STEP_K;
+  uint8_t frac = (uint16_t)(offset % STEP_K) * 256 / STEP_K;
+  const Rgb8 &a = KELVIN_TABLE.rgb[i];
+  const Rgb8 &b = KELVIN_TABLE.rgb[i + 1];
+  return Rgb8{(uint8_t)(a.r + (((b.r - a.r) * frac) >> 8)),
+              (uint8_t)(a.g + (((b.g - a.g) * frac) >> 8)),
+              (uint8_t)(a.b + (((b.b - a.b) * frac) >> 8))};
+}
+
+#endif
@@ -0,0 +1,216 @@
+#include "layers.h"
+#include "natural_light.h"
+#include "circadian.h"
+#include "segments.h"
+#include "spatial_effects.h"
+#include "time_sync.h"
+#include "text_util.h"
+
+namespace
+{
+  const char *const SOURCE_NAMES[LAYER_SOURCE_COUNT] = {"rainbow", "natural", "starlight", "segments", "sweep", "ripple", "radial"};
+  const char *const BLEND_NAMES[BLEND_COUNT] = {"normal", "add", "screen", "max"};
+
+  // 各内核按字节处理（CRGB为3个紧凑字节），a = alpha + 1 使alpha为255时结果精确等于混合值
+  void blendNormal(uint8_t *d, const uint8_t *s, uint16_t n, uint16_t a)
+  {
+    uint16_t ia = 256 - a;
+    for (uint16_t i = 0; i < n; i++)
+      d[i] = (d[i] * ia + s[i] * a) >> 8;
+  }
+
+  void blendAdd(uint8_t *d, const uint8_t *s, uint16_t n, uint16_t a)
+  {
+    for (uint16_t i = 0; i < n; i++)
+    {
+      uint16_t v = d[i] + ((s[i] * a) >> 8);
+      d[i] = v > 255 ? 255 : v;
+    }
+  }
+
+  // 滤色对src是线性的，先按不透明度缩放src即等价于插值
+  void blendScreen(uint8_t *d, const uint8_t *s, uint16_t n, uint16_t a)
+  {
+    for (uint16_t i = 0; i < n; i++)
+    {
+      uint16_t sc = (s[i] * a) >> 8;
+      d[i] += (sc * (256 - d[i])) >> 8;
+    }
+  }
+
+  void blendMax(uint8_t *d, const uint8_t *s, uint16_t n, uint16_t a)
+  {
+    for (uint16_t i = 0; i < n; i++)
+    {
+      if (s[i] > d[i])
+        d[i] += ((s[i] - d[i]) * a) >> 8;
+    }
+  }
+
+  typedef void (*BlendKernel)(uint8_t *d, const uint8_t *s, uint16_t n, uint16_t a);
+
+  const BlendKernel KERNELS[BLEND_COUNT] = {blendNormal, blendAdd, blendScreen, blendMax};
+
+  // 默认：彩虹打底，星光以滤色叠加在上面
+  const LayerStack::Layer DEFAULT_LAYERS[] = {
+      {LAYER_RAINBOW, BLEND_NORMAL, 255},
+      {LAYER_STARLIGHT, BLEND_SCREEN, 255},
+  };
+}
+
+LayerStack layerStack;
+
+void blendLayer(CRGB *dst, const CRGB *src, uint16_t count, BlendMode mode, uint8_t alpha)
+{
+  if (alpha == 0 || mode >= BLEND_COUNT)
+    return;
+  KERNELS[mode](dst->raw, src->raw, count * 3, alpha + 1);
+}
+
+LayerStack::LayerStack()
+    : count(0)
+{
+  setLayers(DEFAULT_LAYERS, sizeof(DEFAULT_LAYERS) / sizeof(DEFAULT_LAYERS[0]));
+}
+
+void LayerStack::begin()
+{
+  starlight.begin(layerMain, layerRing);
+}
+
+bool LayerStack::setLayers(const Layer *list, uint8_t n)
+{
+  if (n == 0 || n > MAX_LAYERS)
+    return false;
+  for (uint8_t i = 0; i < n; i++)
+  {
+    if (list[i].source >= LAYER_SOURCE_COUNT || list[i].blend >= BLEND_COUNT)
+      return false;
+  }
+  memcpy(layers, list, n * sizeof(Layer));
+  count = n;
+  return true;
+}
+
+bool LayerStack::parse(const String &text)
+{
+  Layer list[MAX_LAYERS];
+  uint8_t n = 0;
+  const char *p = text.c_str();
+  while (*p)
+  {
+    char source[12], blend[8];
+    unsigned alpha;
+    int used = 0;
+    if (n >= MAX_LAYERS || sscanf(p, "%11[a-z],%7[a-z],%u%n", source, blend, &alpha, &used) != 3)
+      return false;
+    int8_t sourceId = findName(SOURCE_NAMES, LAYER_SOURCE_COUNT, source);
+    int8_t blendId = findName(BLEND_NAMES, BLEND_COUNT, blend);
+    if (sourceId < 0 || blendId < 0 || alpha > 255)
+      return false;
+    list[n++] = Layer{(uint8_t)sourceId, (uint8_t)blendId, (uint8_t)alpha};
+    p += used;
+    if (*p == ';')
+      p++;
+    else if (*p)
+      return false;
+  }
+  return setLayers(list, n);
+}
+
+String LayerStack::toString() const
+{
+  String text;
+  char item[32];
+  for (uint8_t i = 0; i < count; i++)
+  {
+    snprintf(item, sizeof(item), "%s%s,%s,%u", i ? ";" : "",
+             SOURCE_NAMES[layers[i].source], BLEND_NAMES[layers[i].blend], layers[i].alpha);
+    text += item;
+  }
+  return text;
+}
+
+uint8_t LayerStack::getCount() const
+{
+  return count;
+}
+
+// 从黑色开始逐层混合；每层共用同一对图层缓冲区，渲染完立即混合
+void LayerStack::render(CRGB *main, CRGB *ring, uint32_t nowMs)
+{
+  fill_solid(main, Config::MAIN_NUM_LEDS, CRGB::Black);
+  fill_solid(ring, Config::RING_NUM_LEDS, CRGB::Black);
+  for (uint8_t i = 0; i < count; i++)
+  {
+    renderSource(layers[i].source, nowMs);
+    blendLayer(main, layerMain, Config::MAIN_NUM_LEDS, (BlendMode)layers[i].blend, layers[i].alpha);
+    blendLayer(ring, layerRing, Config::RING_NUM_LEDS, (BlendMode)layers[i].blend, layers[i].alpha);
+  }
+}
+
+void LayerStack::renderSource(uint8_t source, uint32_t nowMs)
+{
+  switch (source)
+  {
+  case LAYER_RAINBOW:
+  {
+    // 与彩虹模式相同的色相推进
+    uint8_t hue = (uint8_t)(nowMs / Config::RAINBOW_HUE_STEP_MS);
+    fill_rainbow(layerMain, Config::MAIN_NUM_LEDS, hue, 255 / Config::MAIN_NUM_LEDS);
+    fill_rainbow(layerRing, Config::RING_NUM_LEDS, hue + 64, 255 / Config::RING_NUM_LEDS);
+    break;
+  }
+  case LAYER_NATURAL:
+  {
+    NaturalLight light;
+    light.configure(circadian.warmWhite(255, -300), circadian.warmWhite(255, 600));
+    light.render(layerMain, Config::MAIN_NUM_LEDS, nowMs);
+    light.render(layerRing, Config::RING_NUM_LEDS, nowMs + 7919);
+    break;
+  }
+  case LAYER_STARLIGHT:
+    fill_solid(layerMain, Config::MAIN_NUM_LEDS, CRGB::Black);
+    starlight.renderOverlay(layerRing);
+    break;
+  case LAYER_SEGMENTS:
+    segmentCompositor.render(layerMain, layerRing, nowMs);
+    break;
+  case LAYER_SWEEP:
+    renderSweep(layerMain, layerRing, nowMs);
+    break;
+  case LAYER_RIPPLE:
+    renderRipple(layerMain, layerRing, nowMs);
+    break;
+  case LAYER_RADIAL:
+    renderRadial(layerMain, layerRing, nowMs);
+    break;
+  default:
+    break;
+  }
+}
+
+// 混合内核在主灯带+灯环全部像素上计时（除以像素数即每层每像素开销），再测默认两层的整帧合成
+void LayerStack::benchmark(BenchmarkSuite &suite)
+{
+  static const uint16_t PIXELS = Config::MAIN_NUM_LEDS + Config::RING_NUM_LEDS;
+  static CRGB dst[PIXELS];
+  static CRGB src[PIXELS];
+  static CRGB scratchMain[Config::MAIN_NUM_LEDS];
+  static CRGB scratchRing[Config::RING_NUM_LEDS];
+  static LayerStack probe;
+  for (uint16_t i = 0; i < PIXELS; i++)
+  {
+    dst[i] = CRGB(random8(), random8(), random8());
+    src[i] = CRGB(random8(), random8(), random8());
+  }
+
+  suite.run("blend_normal", 500, [&]() { blendLayer(dst, src, PIXELS, BLEND_NORMAL, 200); });
+  suite.run("blend_add", 500, [&]() { blendLayer(dst, src, PIXELS, BLEND_ADD, 200); });
+  suite.run("blend_screen", 500, [&]() { blendLayer(dst, src, PIXELS, BLEND_SCREEN, 200); });
+  suite.run("blend_max", 500, [&]() { blendLayer(dst, src, PIXELS, BLEND_MAX, 200); });
+
+  uint32_t t = 0;
+  probe.begin();
+  suite.run("layers_rainbow_stars", 200, [&]() { probe.render(scratchMain, scratchRing, timeSync.now() + (t += 10)); });
+}
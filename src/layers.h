@@ -0,0 +1,68 @@
+#ifndef LAYERS_H
+#define LAYERS_H
+
+#include <Arduino.h>
+#include <FastLED.h>
+#include "config.h"
+#include "benchmark.h"
+#include "Breath_Starlight.h"
+
+// 图层合成：每层渲染到自己的缓冲区，再按混合模式和不透明度叠加到下面的结果上
+enum BlendMode : uint8_t
+{
+  BLEND_NORMAL,    // 按不透明度插值
+  BLEND_ADD,       // 饱和相加
+  BLEND_SCREEN,    // 滤色：1-(1-a)(1-b)，不会过曝
+  BLEND_MAX,       // 逐通道取较亮者
+  BLEND_COUNT
+};
+
+enum LayerSource : uint8_t
+{
+  LAYER_RAINBOW,
+  LAYER_NATURAL,   // 跟随昼夜节律的自然光
+  LAYER_STARLIGHT, // 只有星点，背景透明（黑）
+  LAYER_SEGMENTS,  // 当前分段布局
+  LAYER_SWEEP,     // 以下为按几何坐标渲染的空间效果
+  LAYER_RIPPLE,
+  LAYER_RADIAL,
+  LAYER_SOURCE_COUNT
+};
+
+// 8位定点混合内核：dst = mode(dst, src)，再按alpha(0-255)与原dst插值
+void blendLayer(CRGB *dst, const CRGB *src, uint16_t count, BlendMode mode, uint8_t alpha);
+
+class LayerStack
+{
+public:
+  static const uint8_t MAX_LAYERS = 4;
+
+  struct Layer
+  {
+    uint8_t source;   // LayerSource
+    uint8_t blend;    // BlendMode
+    uint8_t alpha;
+  };
+
+  LayerStack();
+  void begin();                             // 进入图层模式时重置有状态的图层（星光）
+  bool setLayers(const Layer *list, uint8_t count);
+  bool parse(const String &text);           // "来源,混合,不透明度;..."，第一层在最底下
+  String toString() const;
+  uint8_t getCount() const;
+  void render(CRGB *main, CRGB *ring, uint32_t nowMs);
+  void benchmark(BenchmarkSuite &suite);
+
+private:
+  Layer layers[MAX_LAYERS];
+  uint8_t count;
+  CRGB layerMain[Config::MAIN_NUM_LEDS];
+  CRGB layerRing[Config::RING_NUM_LEDS];
+  BreathStarlight starlight;                // 独立的星光实例，不影响星光模式
+
+  void renderSource(uint8_t source, uint32_t nowMs);
+};
+
+extern LayerStack layerStack;
+
+#endif
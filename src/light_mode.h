@@ -0,0 +1,26 @@
+#ifndef LIGHT_MODE_H
+#define LIGHT_MODE_H
+
+// 用户可选模式（与网页 /control?mode= 参数一一对应，数值会写入NVS，只能追加）
+// 不依赖Arduino头文件，主机端日志解码器也用这里的模式名
+enum LightMode
+{
+  MODE_OFF,
+  MODE_BREATHE,
+  MODE_RAINBOW,
+  MODE_MANUAL,
+  MODE_AUTO,
+  MODE_STARLIGHT,
+  MODE_TIMELINE,
+  MODE_SEGMENTS,
+  MODE_LAYERS,
+  MODE_COUNT
+};
+
+// 模式名称，下标与LightMode一致（网页参数、日程和日志共用）
+inline constexpr const char *MODE_NAMES[MODE_COUNT] = {
+    "off", "breathe", "rainbow", "manual", "auto", "starlight", "timeline", "segments", "layers"};
+
+static_assert(MODE_NAMES[MODE_COUNT - 1] != nullptr, "every LightMode needs a name");
+
+#endif
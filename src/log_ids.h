@@ -0,0 +1,57 @@
+#ifndef LOG_IDS_H
+#define LOG_IDS_H
+
+// 二进制日志消息表：设备端只记录编号和参数，主机端 tools/log_decoder.cpp 用同一张表还原文本
+// 只能在末尾追加，不要改动已有条目的顺序
+// 格式说明：%d 有符号整数，%u 无符号整数，%m 模式名（LightMode）
+#define BINLOG_MESSAGES(X)                                                        \
+  X(STAR_SPAWN, BINLOG_LEVEL_DEBUG, 3, "✨ 新生星点 #%d 位置:%d 寿命:%ums")        \
+  X(BRIGHTNESS_SET, BINLOG_LEVEL_INFO, 1, "亮度已设置为: %d")                      \
+  X(MODE_SET, BINLOG_LEVEL_INFO, 1, "设置模式: %m")                                \
+  X(MODE_UNKNOWN, BINLOG_LEVEL_WARN, 0, "未知模式")                                \
+  X(TIMELINE_MISSING, BINLOG_LEVEL_WARN, 0, "没有可播放的时间轴")                  \
+  X(ROOT_REQUEST, BINLOG_LEVEL_DEBUG, 0, "收到网页请求")                           \
+  X(CONTROL_REQUEST, BINLOG_LEVEL_DEBUG, 0, "收到控制请求")                        \
+  X(CONTROL_RESPONSE, BINLOG_LEVEL_INFO, 2, "控制响应: 投递%d条命令 成功=%d")      \
+  X(MOTION, BINLOG_LEVEL_INFO, 1, "人体状态: %d (1=检测到移动 0=无人)")            \
+  X(STREAM_START, BINLOG_LEVEL_INFO, 0, "收到像素流，切换到像素流模式")            \
+  X(STREAM_TIMEOUT, BINLOG_LEVEL_INFO, 0, "像素流超时，恢复原模式")              \
+  X(SCHEDULE_FIRE, BINLOG_LEVEL_INFO, 2, "日程触发: 第%u分钟 -> %m")
+
+enum BinlogLevel
+{
+  BINLOG_LEVEL_DEBUG,
+  BINLOG_LEVEL_INFO,
+  BINLOG_LEVEL_WARN,
+  BINLOG_LEVEL_ERROR,
+  BINLOG_LEVEL_NONE
+};
+
+enum BinlogId
+{
+#define BINLOG_ENUM(name, level, argc, format) LOGID_##name,
+  BINLOG_MESSAGES(BINLOG_ENUM)
+#undef BINLOG_ENUM
+  LOGID_COUNT
+};
+
+struct BinlogMessage
+{
+  BinlogLevel level;
+  unsigned char argc;
+  const char *format;
+};
+
+constexpr BinlogMessage BINLOG_TABLE[LOGID_COUNT] = {
+#define BINLOG_ENTRY(name, level, argc, format) {level, argc, format},
+    BINLOG_MESSAGES(BINLOG_ENTRY)
+#undef BINLOG_ENTRY
+};
+
+// 线上帧格式：A5 5A | u32 时间(ms) | u16 编号 | u8 参数个数 | u8 校验(前面各字节异或) | 参数 x i32
+constexpr unsigned char BINLOG_SYNC0 = 0xA5;
+constexpr unsigned char BINLOG_SYNC1 = 0x5A;
+constexpr unsigned BINLOG_HEADER_SIZE = 10;
+constexpr unsigned BINLOG_MAX_ARGS = 3;
+
+#endif
@@ -0,0 +1,202 @@
+#include "loop_profiler.h"
+#include "state_machine.h"
+#include "text_util.h"
+#include <stdio.h>
+#include <string.h>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <chrono>
+#endif
+
+LoopProfiler loopProfiler;
+
+static const char *const SECTION_NAMES[PROF_COUNT] = {
+    "loop", "client", "motion", "update", "render", "show"};
+
+static uint32_t nowMs()
+{
+#ifdef ARDUINO
+  return millis();
+#else
+  using namespace std::chrono;
+  return (uint32_t)duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+uint32_t LoopProfiler::cycles()
+{
+#ifdef ARDUINO
+  return ESP.getCycleCount();
+#else
+  using namespace std::chrono;
+  return (uint32_t)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+uint32_t LoopProfiler::cyclesPerUs()
+{
+#ifdef ARDUINO
+  // 每次读取当前主频，降频后换算仍然正确
+  return ESP.getCpuFreqMHz();
+#else
+  return 1000;
+#endif
+}
+
+uint32_t LoopProfiler::cyclesToUs(uint32_t c)
+{
+  return c / cyclesPerUs();
+}
+
+LoopProfiler::LoopProfiler()
+{
+  reset();
+}
+
+void LoopProfiler::reset()
+{
+  memset(sections, 0, sizeof(sections));
+  for (uint8_t i = 0; i < PROF_COUNT; i++)
+    sections[i].minUs = UINT32_MAX;
+  memset(current, 0, sizeof(current));
+  memset(slowest, 0, sizeof(slowest));
+  slowestCount = 0;
+  ranMask = 0;
+  iterationStart = cycles();
+}
+
+void LoopProfiler::beginIteration()
+{
+  memset(current, 0, sizeof(current));
+  ranMask = 0;
+  iterationStart = cycles();
+}
+
+void LoopProfiler::record(ProfileSection section, uint32_t elapsedCycles)
+{
+  current[section] += cyclesToUs(elapsedCycles);
+  ranMask |= 1u << section;
+}
+
+// 对数分桶：每个2倍区间分SUB_BUCKETS档，p99误差约在25%以内
+uint8_t LoopProfiler::bucketOf(uint32_t us)
+{
+  if (us == 0)
+    return 0;
+  uint8_t msb = 31 - __builtin_clz(us);
+  uint8_t sub = msb >= 2 ? (us >> (msb - 2)) & 3 : (us << (2 - msb)) & 3;
+  uint16_t index = msb * SUB_BUCKETS + sub;
+  return index < BUCKETS ? index : BUCKETS - 1;
+}
+
+uint32_t LoopProfiler::bucketUpper(uint8_t bucket)
+{
+  uint8_t octave = bucket / SUB_BUCKETS;
+  uint8_t sub = bucket % SUB_BUCKETS;
+  return (((uint64_t)(SUB_BUCKETS + sub + 1)) << octave) / SUB_BUCKETS;
+}
+
+void LoopProfiler::endIteration(uint8_t phase, bool autoMode)
+{
+  record(PROF_LOOP, cycles() - iterationStart);
+
+  for (uint8_t i = 0; i < PROF_COUNT; i++)
+  {
+    if (!(ranMask & (1u << i)))
+      continue;
+    Section &s = sections[i];
+    uint32_t us = current[i];
+    s.count++;
+    s.sumUs += us;
+    if (us < s.minUs)
+      s.minUs = us;
+    if (us > s.maxUs)
+      s.maxUs = us;
+    s.buckets[bucketOf(us)]++;
+  }
+
+  // 插入最慢迭代列表（降序，列表很短，直接插入排序）
+  uint32_t total = current[PROF_LOOP];
+  if (slowestCount < SLOWEST || total > slowest[SLOWEST - 1].sectionUs[PROF_LOOP])
+  {
+    uint8_t pos = slowestCount < SLOWEST ? slowestCount++ : SLOWEST - 1;
+    while (pos > 0 && slowest[pos - 1].sectionUs[PROF_LOOP] < total)
+    {
+      slowest[pos] = slowest[pos - 1];
+      pos--;
+    }
+    Iteration &it = slowest[pos];
+    it.atMs = nowMs();
+    memcpy(it.sectionUs, current, sizeof(current));
+    it.phase = phase;
+    it.autoMode = autoMode;
+  }
+}
+
+LoopProfiler::SectionStats LoopProfiler::getStats(ProfileSection section) const
+{
+  const Section &s = sections[section];
+  SectionStats stats = {s.count, s.count ? s.minUs : 0, s.maxUs, s.sumUs, 0};
+  if (s.count == 0)
+    return stats;
+
+  uint32_t target = s.count - s.count / 100;
+  uint32_t cumulative = 0;
+  for (uint8_t b = 0; b < BUCKETS; b++)
+  {
+    cumulative += s.buckets[b];
+    if (cumulative >= target)
+    {
+      uint32_t upper = bucketUpper(b);
+      stats.p99Us = upper < s.maxUs ? upper : s.maxUs;
+      break;
+    }
+  }
+  return stats;
+}
+
+const char *LoopProfiler::sectionName(ProfileSection section)
+{
+  return section < PROF_COUNT ? SECTION_NAMES[section] : "?";
+}
+
+size_t LoopProfiler::render(char *out, size_t cap) const
+{
+  size_t used = 0;
+  used = appendf(out, cap, used, "%-8s %10s %8s %8s %8s %8s\n",
+                 "section", "count", "min_us", "avg_us", "p99_us", "max_us");
+  for (uint8_t i = 0; i < PROF_COUNT; i++)
+  {
+    SectionStats s = getStats((ProfileSection)i);
+    used = appendf(out, cap, used, "%-8s %10lu %8lu %8lu %8lu %8lu\n",
+                   SECTION_NAMES[i], (unsigned long)s.count, (unsigned long)s.minUs,
+                   (unsigned long)(s.count ? s.sumUs / s.count : 0),
+                   (unsigned long)s.p99Us, (unsigned long)s.maxUs);
+  }
+
+  used = appendf(out, cap, used, "slowest iterations:\n");
+  for (uint8_t i = 0; i < slowestCount; i++)
+  {
+    const Iteration &it = slowest[i];
+    used = appendf(out, cap, used, "%2u %8luus phase=%s auto=%u at=%lums",
+                   i + 1, (unsigned long)it.sectionUs[PROF_LOOP], phaseName(it.phase),
+                   it.autoMode ? 1 : 0, (unsigned long)it.atMs);
+    for (uint8_t j = PROF_CLIENT; j < PROF_COUNT; j++)
+      used = appendf(out, cap, used, " %s=%lu", SECTION_NAMES[j], (unsigned long)it.sectionUs[j]);
+    used = appendf(out, cap, used, "\n");
+  }
+  return used;
+}
+
+ProfileScope::ProfileScope(ProfileSection section)
+    : section(section),
+      start(LoopProfiler::cycles())
+{
+}
+
+ProfileScope::~ProfileScope()
+{
+  loopProfiler.record(section, LoopProfiler::cycles() - start);
+}
@@ -0,0 +1,113 @@
+#ifndef LOOP_PROFILER_H
+#define LOOP_PROFILER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// 设为0可在编译期去掉全部剖析代码
+#ifndef LOOP_PROFILER_ENABLED
+#define LOOP_PROFILER_ENABLED 1
+#endif
+
+// 剖析区段：前四个在loop()中，RENDER/SHOW为update()内部的细分
+enum ProfileSection : uint8_t
+{
+  PROF_LOOP,      // 整个迭代
+  PROF_CLIENT,    // handleClient()
+  PROF_MOTION,    // CheckMotion()
+  PROF_UPDATE,    // update()
+  PROF_RENDER,    // update()中的效果渲染
+  PROF_SHOW,      // update()中的stableShow()
+  PROF_COUNT
+};
+
+// 主循环剖析器：不依赖Arduino，桌面编译时使用steady_clock代替周期计数器
+class LoopProfiler
+{
+public:
+  static const uint8_t SLOWEST = 8;       // 记录最慢的迭代数
+  static const uint8_t SUB_BUCKETS = 4;   // 每个2倍区间再分4档
+  static const uint8_t OCTAVES = 24;      // 1us ~ 16s
+  static const uint8_t BUCKETS = SUB_BUCKETS * OCTAVES;
+
+  struct SectionStats
+  {
+    uint32_t count;
+    uint32_t minUs;
+    uint32_t maxUs;
+    uint64_t sumUs;
+    uint32_t p99Us;
+  };
+
+  struct Iteration
+  {
+    uint32_t atMs;
+    uint32_t sectionUs[PROF_COUNT];
+    uint8_t phase;
+    bool autoMode;
+  };
+
+  LoopProfiler();
+
+  // 周期计数器（ESP32为CPU周期，桌面为纳秒），只取差值，32位回绕无影响
+  static uint32_t cycles();
+  static uint32_t cyclesPerUs();
+  static uint32_t cyclesToUs(uint32_t c);
+
+  void beginIteration();
+  void record(ProfileSection section, uint32_t elapsedCycles);
+  void endIteration(uint8_t phase, bool autoMode);
+  void reset();
+
+  SectionStats getStats(ProfileSection section) const;
+  static const char *sectionName(ProfileSection section);
+
+  // 文本报告，串口和HTTP共用同一格式
+  size_t render(char *out, size_t cap) const;
+
+private:
+  struct Section
+  {
+    uint32_t count;
+    uint32_t minUs;
+    uint32_t maxUs;
+    uint64_t sumUs;
+    uint32_t buckets[BUCKETS];
+  };
+
+  Section sections[PROF_COUNT];
+  uint32_t current[PROF_COUNT];   // 本次迭代各区段耗时（us）
+  uint32_t iterationStart;
+  uint8_t ranMask;                // 本次迭代执行过的区段
+  Iteration slowest[SLOWEST];     // 按总耗时降序
+  uint8_t slowestCount;
+
+  static uint8_t bucketOf(uint32_t us);
+  static uint32_t bucketUpper(uint8_t bucket);
+};
+
+// 作用域计时：构造时取周期计数，析构时记入对应区段
+class ProfileScope
+{
+public:
+  explicit ProfileScope(ProfileSection section);
+  ~ProfileScope();
+
+private:
+  ProfileSection section;
+  uint32_t start;
+};
+
+extern LoopProfiler loopProfiler;
+
+#if LOOP_PROFILER_ENABLED
+#define PROFILE_BEGIN() loopProfiler.beginIteration()
+#define PROFILE_END(phase, autoMode) loopProfiler.endIteration(phase, autoMode)
+#define PROFILE_SCOPE(section) ProfileScope profileScope##section(section)
+#else
+#define PROFILE_BEGIN() do {} while (0)
+#define PROFILE_END(phase, autoMode) do {} while (0)
+#define PROFILE_SCOPE(section) do {} while (0)
+#endif
+
+#endif
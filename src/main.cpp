@@ -2,72 +2,179 @@
 #include "config.h"
 #include "LED_Controller.h"
 #include "motion_sensor.h"
+#include "wifi_manager.h"
+#include "settings_store.h"
+#include "time_sync.h"
+#include "binary_log.h"
+#include "metrics.h"
+#include "loop_profiler.h"
+#include "frame_scheduler.h"
+#include "power_manager.h"
+#include "circadian.h"
+#include "schedule.h"
+#include "preview_stream.h"
+#include "stress_test.h"
+#include "offline_render.h"
 
 // 使用全局实例
 extern LEDController ledController;
 extern MotionSensor motionsensor;
 
+// 启动到首帧耗时统计
+static unsigned long bootMicros = 0;
+static uint32_t bootFrameCount = 0;
+static bool firstFrameReported = false;
+
+// 主循环耗时统计（用于对比日志开/关）
+static const unsigned long LOOP_REPORT_MS = 10000;
+static unsigned long loopReportStart = 0;
+static uint32_t loopCount = 0;
+static uint32_t loopMicrosTotal = 0;
+static uint32_t loopMicrosMax = 0;
+
 void setup()
 {
+    bootMicros = micros();
     Serial.begin(115200);
 
     pinMode(Config::BOARD_LED_PIN, OUTPUT);
-    pinMode(Config::MOTION_SENSOR_PIN, INPUT);
 
     Serial.println("====================================");
     Serial.println("双灯环系统启动 - WiFi控制版");
     Serial.println("====================================");
 
-    // 先连接WiFi，再初始化LED控制器
-    Serial.println("正在连接WiFi...");
+    frameScheduler.begin();
+    motionsensor.begin();
+    timeSync.begin();
+    binaryLog.begin();
 
-    // 配置静态IP
-    if (!WiFi.config(Config::localIP(), Config::gateway(), Config::subnet()))
+    // 首帧之前恢复亮度、颜色和上次模式
+    settingsStore.begin();
+    LightSettings saved;
+    if (settingsStore.load(saved))
     {
-        Serial.println("STA Failed to configure");
+        ledController.applySettings(saved);
     }
 
-    WiFi.begin(Config::wifiSSID(), Config::wifiPassword());
+    // 先启动LED和上次模式（默认自动模式），WiFi在后台状态机中连接
+    ledController.begin();
+    bootFrameCount = ledController.getFrameCount();
+    ledController.restoreMode();
+
+    // WiFi.mode()完成网络栈初始化后才能启动Web服务器
+    wifiManager.begin();
+    circadian.begin();
+    modeSchedule.begin();
+    ledController.beginServer();
+}
 
-    int attempts = 0;
-    while (WiFi.status() != WL_CONNECTED && attempts < 30)
+// 串口输入 p 打印剖析报告，r 清零
+static void handleSerialCommands()
+{
+    static char report[2048];
+    while (Serial.available() > 0)
     {
-        delay(500);
-        Serial.print(".");
-        attempts++;
-        digitalWrite(Config::BOARD_LED_PIN, !digitalRead(Config::BOARD_LED_PIN));
+        int c = Serial.read();
+        if (c == 'p')
+        {
+            loopProfiler.render(report, sizeof(report));
+            Serial.print(report);
+        }
+        else if (c == 'r')
+        {
+            loopProfiler.reset();
+            Serial.println("剖析数据已清零");
+        }
     }
+}
+
+void loop()
+{
+    unsigned long loopStart = micros();
+    PROFILE_BEGIN();
+
+    // 推进WiFi连接/重连状态机
+    wifiManager.loop();
+
+    // 多设备效果时钟同步
+    timeSync.loop();
+
+    // 昼夜节律色温（每秒重算一次）
+    circadian.loop();
+
+    // 定时切换模式（只看最小堆堆顶）
+    modeSchedule.loop(millis());
 
-    if (WiFi.status() == WL_CONNECTED)
+    // 压力测试运行时按时间表切换效果、翻转模拟的人体传感器
+    stressTest.loop(millis());
+
+    // 处理网络请求
     {
-        Serial.println("\nWiFi连接成功!");
-        Serial.print("IP地址: ");
-        Serial.println(WiFi.localIP());
-        digitalWrite(Config::BOARD_LED_PIN, HIGH);
+        PROFILE_SCOPE(PROF_CLIENT);
+        ledController.handleClient();
     }
-    else
+
+    // 更新传感器状态
     {
-        Serial.println("\nWiFi连接失败，使用离线模式");
-        digitalWrite(Config::BOARD_LED_PIN, LOW);
+        PROFILE_SCOPE(PROF_MOTION);
+        motionsensor.CheckMotion();
     }
 
-    // WiFi连接成功后再初始化LED控制器
-    ledController.begin();
-
-    if (WiFi.status() == WL_CONNECTED)
+    // 更新LED状态
     {
-        ledController.quickTestLeds();
+        PROFILE_SCOPE(PROF_UPDATE);
+        unsigned long updateStart = micros();
+        ledController.update();
+        metrics.updateTime.observe(micros() - updateStart);
     }
-}
 
-void loop()
-{
-    // 处理网络请求
-    ledController.handleClient();
+    // 实时预览：按自己的帧率编码并非阻塞发送，客户端跟不上时丢帧
+    previewStream.loop(millis());
 
-    // 更新传感器状态
-    motionsensor.CheckMotion();
+    // 离线渲染导出：每次只渲染一小片，不打断实时显示
+    offlineRenderer.loop();
 
-    // 更新LED状态
-    ledController.update();
-}
\ No newline at end of file
+    // 合并后的设置写入Flash
+    settingsStore.loop();
+
+    handleSerialCommands();
+    metrics.tick();
+    PROFILE_END(ledController.getPhase(), ledController.isAuto());
+    uint32_t loopMicros = micros() - loopStart;
+    loopCount++;
+    loopMicrosTotal += loopMicros;
+    if (loopMicros > loopMicrosMax)
+        loopMicrosMax = loopMicros;
+    if (millis() - loopReportStart >= LOOP_REPORT_MS)
+    {
+        FrameScheduler::Stats frames = frameScheduler.getStats();
+        Serial.printf("\n主循环: 平均%luus 最大%luus 日志%s 丢弃%lu\n",
+                      (unsigned long)(loopMicrosTotal / loopCount), (unsigned long)loopMicrosMax,
+                      binaryLog.isEnabled() ? "开" : "关", (unsigned long)binaryLog.getDropped());
+        Serial.printf("帧率: 目标%u 实际%u 超时%lu CPU占用%u%%\n",
+                      frames.targetFps, frames.achievedFps, (unsigned long)frames.misses, frames.cpuLoad);
+        PowerManager::Stats power = powerManager.getStats();
+        Serial.printf("功耗: %s %luMHz 待机%lus 浅睡%lus 唤醒延迟 最近%luus 最大%luus 超标%lu\n",
+                      power.idle ? "待机" : "运行", (unsigned long)power.cpuMhz,
+                      (unsigned long)(power.idleUs / 1000000), (unsigned long)(power.lightSleepUs / 1000000),
+                      (unsigned long)power.lastWakeUs, (unsigned long)power.maxWakeUs,
+                      (unsigned long)power.wakesOverTarget);
+        loopReportStart = millis();
+        loopCount = 0;
+        loopMicrosTotal = 0;
+        loopMicrosMax = 0;
+    }
+
+    if (!firstFrameReported && ledController.getFrameCount() > bootFrameCount)
+    {
+        firstFrameReported = true;
+        Serial.print("启动到首帧耗时: ");
+        Serial.print((micros() - bootMicros) / 1000.0f, 1);
+        Serial.println(" ms");
+    }
+
+    // 自动熄灭后进入低功耗待机，然后休眠到下一帧或输入事件
+    powerManager.loop(ledController.isAuto() && ledController.getPhase() == PHASE_OFF,
+                      ledController.getFrameCount());
+    frameScheduler.idle();
+}
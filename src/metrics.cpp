@@ -0,0 +1,145 @@
+#include "metrics.h"
+#include "text_util.h"
+
+Metrics metrics;
+
+const uint32_t LatencyHistogram::BOUNDS_US[BUCKETS] = {
+    50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000};
+const char *const LatencyHistogram::BOUNDS_LABEL[BUCKETS] = {
+    "0.00005", "0.0001", "0.00025", "0.0005", "0.001", "0.0025", "0.005", "0.01", "0.025", "0.05"};
+
+LatencyHistogram::LatencyHistogram()
+    : sumUs(0),
+      count(0)
+{
+  memset(counts, 0, sizeof(counts));
+}
+
+void LatencyHistogram::observe(uint32_t us)
+{
+  uint8_t i = 0;
+  while (i < BUCKETS && us > BOUNDS_US[i])
+    i++;
+  counts[i]++;
+  sumUs += us;
+  count++;
+}
+
+size_t LatencyHistogram::render(char *out, size_t cap, const char *name, const char *help) const
+{
+  size_t used = 0;
+  used = appendf(out, cap, used, "# HELP %s %s\n# TYPE %s histogram\n", name, help, name);
+
+  // Prometheus桶为累计计数
+  uint32_t cumulative = 0;
+  for (uint8_t i = 0; i < BUCKETS; i++)
+  {
+    cumulative += counts[i];
+    used = appendf(out, cap, used, "%s_bucket{le=\"%s\"} %lu\n", name, BOUNDS_LABEL[i], (unsigned long)cumulative);
+  }
+  cumulative += counts[BUCKETS];
+  used = appendf(out, cap, used, "%s_bucket{le=\"+Inf\"} %lu\n", name, (unsigned long)cumulative);
+  used = appendf(out, cap, used, "%s_sum %lu.%06lu\n%s_count %lu\n", name,
+                 (unsigned long)(sumUs / 1000000), (unsigned long)(sumUs % 1000000),
+                 name, (unsigned long)count);
+  return used;
+}
+
+Metrics::Metrics()
+    : loopIterations(0),
+      framesShown(0),
+      framesSkipped(0),
+      httpRequests(0),
+      pirEvents(0),
+      statusRequests(0),
+      statusNotModified(0),
+      statusRenders(0),
+      controlCoalesced(0),
+      loopsPerSecond(0),
+      lastLoopCount(0),
+      lastTick(0)
+{
+}
+
+void Metrics::tick()
+{
+  loopIterations++;
+  unsigned long now = millis();
+  if (now - lastTick >= 1000)
+  {
+    loopsPerSecond = (loopIterations - lastLoopCount) * 1000 / (now - lastTick);
+    lastLoopCount = loopIterations;
+    lastTick = now;
+  }
+}
+
+size_t Metrics::render(char *out, size_t cap) const
+{
+  size_t used = 0;
+  used = appendf(out, cap, used,
+                 "# HELP led_loop_iterations_total Main loop iterations.\n"
+                 "# TYPE led_loop_iterations_total counter\n"
+                 "led_loop_iterations_total %lu\n"
+                 "# HELP led_loop_iterations_per_second Main loop rate over the last second.\n"
+                 "# TYPE led_loop_iterations_per_second gauge\n"
+                 "led_loop_iterations_per_second %lu\n"
+                 "# HELP led_frames_shown_total Frames pushed to the strips.\n"
+                 "# TYPE led_frames_shown_total counter\n"
+                 "led_frames_shown_total %lu\n"
+                 "# HELP led_frames_skipped_total update() passes that had nothing to show.\n"
+                 "# TYPE led_frames_skipped_total counter\n"
+                 "led_frames_skipped_total %lu\n"
+                 "# HELP led_http_requests_total HTTP requests handled.\n"
+                 "# TYPE led_http_requests_total counter\n"
+                 "led_http_requests_total %lu\n"
+                 "# HELP led_pir_events_total PIR state changes.\n"
+                 "# TYPE led_pir_events_total counter\n"
+                 "led_pir_events_total %lu\n"
+                 "# HELP led_status_requests_total Requests to /status.\n"
+                 "# TYPE led_status_requests_total counter\n"
+                 "led_status_requests_total %lu\n"
+                 "# HELP led_status_not_modified_total Conditional requests answered with 304.\n"
+                 "# TYPE led_status_not_modified_total counter\n"
+                 "led_status_not_modified_total %lu\n"
+                 "# HELP led_status_renders_total Status payload rebuilds after a state change.\n"
+                 "# TYPE led_status_renders_total counter\n"
+                 "led_status_renders_total %lu\n"
+                 "# HELP led_control_coalesced_total Slider and colour updates superseded before being applied.\n"
+                 "# TYPE led_control_coalesced_total counter\n"
+                 "led_control_coalesced_total %lu\n",
+                 (unsigned long)loopIterations, (unsigned long)loopsPerSecond,
+                 (unsigned long)framesShown, (unsigned long)framesSkipped,
+                 (unsigned long)httpRequests, (unsigned long)pirEvents,
+                 (unsigned long)statusRequests, (unsigned long)statusNotModified,
+                 (unsigned long)statusRenders, (unsigned long)controlCoalesced);
+
+  used += updateTime.render(out + used, cap - used, "led_update_duration_seconds", "Time spent in LEDController::update().");
+  used += showTime.render(out + used, cap - used, "led_show_duration_seconds", "Time spent in FastLED.show().");
+  used += httpLatency.render(out + used, cap - used, "led_http_request_duration_seconds", "HTTP handler latency.");
+  used += previewEncodeTime.render(out + used, cap - used, "led_preview_encode_duration_seconds", "Preview frame delta encoding time.");
+
+  used = appendf(out, cap, used,
+                 "# HELP led_heap_free_bytes Free heap.\n"
+                 "# TYPE led_heap_free_bytes gauge\n"
+                 "led_heap_free_bytes %lu\n"
+                 "# HELP led_heap_largest_free_block_bytes Largest allocatable heap block.\n"
+                 "# TYPE led_heap_largest_free_block_bytes gauge\n"
+                 "led_heap_largest_free_block_bytes %lu\n"
+                 "# HELP led_uptime_seconds Time since boot.\n"
+                 "# TYPE led_uptime_seconds counter\n"
+                 "led_uptime_seconds %lu\n",
+                 (unsigned long)ESP.getFreeHeap(), (unsigned long)ESP.getMaxAllocHeap(),
+                 (unsigned long)(millis() / 1000));
+  return used;
+}
+
+HttpRequestTimer::HttpRequestTimer()
+    : start(micros())
+{
+}
+
+HttpRequestTimer::~HttpRequestTimer()
+{
+  metrics.httpRequests++;
+  metrics.httpLatency.observe(micros() - start);
+}
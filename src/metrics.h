@@ -0,0 +1,65 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <Arduino.h>
+
+// 固定桶直方图（微秒），观测只做一次线性查找和几次加法
+class LatencyHistogram
+{
+public:
+  static const uint8_t BUCKETS = 10;
+  static const uint32_t BOUNDS_US[BUCKETS];
+  static const char *const BOUNDS_LABEL[BUCKETS];   // 以秒为单位的le标签
+
+  LatencyHistogram();
+  void observe(uint32_t us);
+  size_t render(char *out, size_t cap, const char *name, const char *help) const;
+
+private:
+  uint32_t counts[BUCKETS + 1];   // 最后一个为+Inf
+  uint64_t sumUs;
+  uint32_t count;
+};
+
+// 运行指标：全部为预分配的普通计数器，/metrics 输出到固定缓冲区
+class Metrics
+{
+public:
+  uint32_t loopIterations;
+  uint32_t framesShown;
+  uint32_t framesSkipped;      // update()执行了但本帧无需刷新
+  uint32_t httpRequests;
+  uint32_t pirEvents;
+  uint32_t statusRequests;
+  uint32_t statusNotModified;  // 以304应答的条件请求（含首页）
+  uint32_t statusRenders;      // 状态变化后重建缓存的次数
+  uint32_t controlCoalesced;   // 未应用就被新值覆盖的滑块/取色器请求
+  LatencyHistogram updateTime;
+  LatencyHistogram showTime;
+  LatencyHistogram httpLatency;
+  LatencyHistogram previewEncodeTime;  // 预览流每帧的差分编码耗时
+
+  Metrics();
+  void tick();                 // 每次loop调用，按秒统计循环速率
+  size_t render(char *out, size_t cap) const;
+
+private:
+  uint32_t loopsPerSecond;
+  uint32_t lastLoopCount;
+  unsigned long lastTick;
+};
+
+// 网页请求计时：构造时开始，析构时计入请求数和延迟直方图
+class HttpRequestTimer
+{
+public:
+  HttpRequestTimer();
+  ~HttpRequestTimer();
+
+private:
+  unsigned long start;
+};
+
+extern Metrics metrics;
+
+#endif
@@ -1,52 +1,61 @@
 #include "motion_sensor.h"
+#include "command_queue.h"
+#include "binary_log.h"
+#include "metrics.h"
+#include "frame_scheduler.h"
+#include "power_manager.h"
 #include <Arduino.h>
 
 MotionSensor motionsensor;
 
 MotionSensor::MotionSensor()
     : lastMotionState(0),
-      currentMotionState(0)
+      currentMotionState(0),
+      simulatedLevel(-1)
 {
 }
 
+// 传感器电平变化时唤醒休眠中的loop，状态仍在CheckMotion中读取
+static void IRAM_ATTR onMotionEdge()
+{
+    powerManager.noteEdgeFromISR();
+    frameScheduler.notifyFromISR();
+}
+
+void MotionSensor::begin()
+{
+    pinMode(Config::MOTION_SENSOR_PIN, INPUT);
+    attachInterrupt(digitalPinToInterrupt(Config::MOTION_SENSOR_PIN), onMotionEdge, CHANGE);
+}
+
+// 模拟电平同样从CheckMotion进入，与真实边沿走完全相同的路径
+void MotionSensor::simulate(int level)
+{
+    simulatedLevel = level;
+}
+
 void MotionSensor::CheckMotion(int force)
 {
-    // 只有在自动模式的时候才触发这个状态
-    /*
-    STATE_AUTO_BREATH,
-    STATE_AUTO_FADE_IN,
-    STATE_AUTO_NORMAL,
-    STATE_AUTO_FADE_OUT,
-    STATE_AUTO_OFF,
-    */
-    if (ledController.getState() == STATE_AUTO_NORMAL ||
-        ledController.getState() == STATE_AUTO_OFF ||
+    // 只有在自动模式且灯光处于稳定阶段（常亮/熄灭）的时候才触发这个状态
+    Phase phase = ledController.getPhase();
+    if ((ledController.isAuto() && (phase == PHASE_NORMAL || phase == PHASE_OFF)) ||
         force == 1)
     {
 
         // 读取人体检测模块状态
         lastMotionState = currentMotionState;
-        currentMotionState = digitalRead(Config::MOTION_SENSOR_PIN);
+        currentMotionState = simulatedLevel >= 0 ? simulatedLevel : digitalRead(Config::MOTION_SENSOR_PIN);
 
         // 检测到状态变化
         if ((currentMotionState != lastMotionState) || force == 1)
         {
             lastMotionState = currentMotionState;
             // lastMotionTime = millis();
-            if (currentMotionState)
-            {
-                Serial.println("🚶 检测到人体移动！");
-                // // digitalWrite(Config::BOARD_LED_PIN, HIGH);
-                ledController.setState(STATE_AUTO_BREATH);
-                ledController.setBreathStep(0);
-                ledController.setStartHue(0);
-            }
-            else
-            {
-                Serial.println("💤 无人体移动");
-                // digitalWrite(Config::BOARD_LED_PIN, LOW);
-                ledController.setState(STATE_AUTO_FADE_OUT);
-            }
+            BINLOG(MOTION, currentMotionState);
+            if (force != 1)
+                metrics.pirEvents++;
+            // 状态切换由控制器在下一帧开始时执行
+            commandQueue.push(Command{CMD_MOTION, (uint8_t)currentMotionState, 0, 0});
         }
         force = 0;
     }
@@ -11,13 +11,16 @@ private:
     // 私有成员变量
     bool lastMotionState;
     bool currentMotionState;
+    volatile int simulatedLevel; // 压力测试注入的电平，-1表示读真实引脚
 
 public:
     // 构造函数
     MotionSensor();
 
     // 公共接口
+    void begin();
     void CheckMotion(int force = 0);
+    void simulate(int level);
 };
 
 extern MotionSensor motionsensor;
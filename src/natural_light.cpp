@@ -0,0 +1,139 @@
+#include "natural_light.h"
+
+namespace
+{
+  // 置换表：编译期用固定种子洗牌生成，相同输入在所有设备上得到相同噪声
+  struct PermTable
+  {
+    uint8_t p[256];
+  };
+
+  constexpr PermTable buildPerm(uint32_t seed)
+  {
+    PermTable t{};
+    for (int i = 0; i < 256; i++)
+      t.p[i] = (uint8_t)i;
+    for (int i = 255; i > 0; i--)
+    {
+      seed = seed * 1664525u + 1013904223u;
+      int j = (seed >> 16) % (i + 1);
+      uint8_t tmp = t.p[i];
+      t.p[i] = t.p[j];
+      t.p[j] = tmp;
+    }
+    return t;
+  }
+
+  // 五次平滑曲线 6u^5 - 15u^4 + 10u^3，u为0-255
+  struct FadeTable
+  {
+    uint8_t f[256];
+  };
+
+  constexpr FadeTable buildFade()
+  {
+    FadeTable t{};
+    for (int i = 0; i < 256; i++)
+    {
+      double u = i / 256.0;
+      double v = u * u * u * (u * (u * 6 - 15) + 10);
+      t.f[i] = (uint8_t)(v * 256.0 > 255.0 ? 255 : v * 256.0);
+    }
+    return t;
+  }
+
+  constexpr PermTable PERM = buildPerm(0x4C4544u);
+  constexpr FadeTable FADE = buildFade();
+
+  // 8个梯度方向：4个轴向 + 4个对角
+  constexpr int8_t GRAD_X[8] = {1, -1, 0, 0, 1, -1, 1, -1};
+  constexpr int8_t GRAD_Y[8] = {0, 0, 1, -1, 1, 1, -1, -1};
+
+  inline uint8_t gradIndex(uint8_t x, uint8_t y)
+  {
+    return PERM.p[(uint8_t)(PERM.p[x] + y)] & 7;
+  }
+}
+
+NaturalLight::NaturalLight()
+    : warm(CRGB::Black),
+      cool(CRGB::Black)
+{
+}
+
+void NaturalLight::configure(const CRGB &warmColor, const CRGB &coolColor)
+{
+  warm = warmColor;
+  cool = coolColor;
+}
+
+// 同一行内时间坐标不变：y方向的梯度项每个格子只算一次，x方向逐像素累加
+void NaturalLight::noiseRow(uint8_t *out, uint8_t count, uint16_t x0, uint16_t xStep, uint16_t y)
+{
+  uint8_t yi = y >> 8;
+  int16_t fy0 = y & 0xFF;
+  int16_t fy1 = fy0 - 256;
+  int32_t v = FADE.f[fy0];
+
+  uint16_t x = x0;
+  int16_t cell = -1;
+  int8_t gx00 = 0, gx10 = 0, gx01 = 0, gx11 = 0;
+  int32_t gy00 = 0, gy10 = 0, gy01 = 0, gy11 = 0;
+
+  for (uint8_t i = 0; i < count; i++, x += xStep)
+  {
+    uint8_t xi = x >> 8;
+    if (xi != cell)
+    {
+      cell = xi;
+      uint8_t g00 = gradIndex(xi, yi);
+      uint8_t g10 = gradIndex(xi + 1, yi);
+      uint8_t g01 = gradIndex(xi, yi + 1);
+      uint8_t g11 = gradIndex(xi + 1, yi + 1);
+      gx00 = GRAD_X[g00];
+      gx10 = GRAD_X[g10];
+      gx01 = GRAD_X[g01];
+      gx11 = GRAD_X[g11];
+      gy00 = GRAD_Y[g00] * fy0;
+      gy10 = GRAD_Y[g10] * fy0;
+      gy01 = GRAD_Y[g01] * fy1;
+      gy11 = GRAD_Y[g11] * fy1;
+    }
+
+    int16_t fx0 = x & 0xFF;
+    int16_t fx1 = fx0 - 256;
+    int32_t n00 = gx00 * fx0 + gy00;
+    int32_t n10 = gx10 * fx1 + gy10;
+    int32_t n01 = gx01 * fx0 + gy01;
+    int32_t n11 = gx11 * fx1 + gy11;
+
+    int32_t u = FADE.f[fx0];
+    int32_t nx0 = n00 + (((n10 - n00) * u) >> 8);
+    int32_t nx1 = n01 + (((n11 - n01) * u) >> 8);
+    int32_t n = nx0 + (((nx1 - nx0) * v) >> 8);
+
+    // n大致落在±290内，乘7/16映射到0-255
+    n = 128 + ((n * 7) >> 4);
+    out[i] = n < 0 ? 0 : n > 255 ? 255 : n;
+  }
+}
+
+void NaturalLight::render(CRGB *leds, uint8_t count, uint32_t nowMs) const
+{
+  uint8_t brightness[MAX_PIXELS];
+  uint8_t temperature[MAX_PIXELS];
+  if (count > MAX_PIXELS)
+    count = MAX_PIXELS;
+
+  // 亮度约4秒漂过一个格子，色温更慢且错开坐标；沿灯带约每12个像素一个格子
+  noiseRow(brightness, count, 0, 21, (uint16_t)(nowMs >> 4));
+  noiseRow(temperature, count, 0x3700, 13, (uint16_t)(nowMs >> 6) + 0x5A00);
+
+  for (uint8_t i = 0; i < count; i++)
+  {
+    CRGB c = blend(warm, cool, temperature[i]);
+    // 154-255：约为峰值的60%-100%，调用方按平均亮度的1.25倍给出峰值颜色
+    c.nscale8_video(154 + scale8(brightness[i], 101));
+    leds[i] = c;
+  }
+}
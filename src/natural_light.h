@@ -0,0 +1,26 @@
+#ifndef NATURAL_LIGHT_H
+#define NATURAL_LIGHT_H
+
+#include <FastLED.h>
+
+// 自然光：用定点二维梯度噪声（位置 x 时间）让亮度和色温沿灯带缓慢漂移
+class NaturalLight
+{
+public:
+  static const uint8_t MAX_PIXELS = 64;
+
+  NaturalLight();
+
+  // warm/cool为两端色温的颜色，亮度在平均值上下约25%波动
+  void configure(const CRGB &warm, const CRGB &cool);
+  void render(CRGB *leds, uint8_t count, uint32_t nowMs) const;
+
+  // 一整行噪声：x从x0开始每像素前进xStep，y为时间坐标，坐标均为Q8.8，输出0-255
+  static void noiseRow(uint8_t *out, uint8_t count, uint16_t x0, uint16_t xStep, uint16_t y);
+
+private:
+  CRGB warm;
+  CRGB cool;
+};
+
+#endif
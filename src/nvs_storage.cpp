@@ -0,0 +1,29 @@
+#include "nvs_storage.h"
+#include <string.h>
+
+MemoryNvs::MemoryNvs()
+    : length(0)
+{
+}
+
+bool MemoryNvs::begin()
+{
+  return true;
+}
+
+size_t MemoryNvs::read(const char *key, void *buf, size_t len)
+{
+  if (length != len)
+    return 0;
+  memcpy(buf, data, len);
+  return len;
+}
+
+size_t MemoryNvs::write(const char *key, const void *buf, size_t len)
+{
+  if (len > CAPACITY)
+    return 0;
+  memcpy(data, buf, len);
+  length = len;
+  return len;
+}
@@ -0,0 +1,33 @@
+#ifndef NVS_STORAGE_H
+#define NVS_STORAGE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// NVS存储抽象：设备上用Preferences，主机/测试或分区异常时用内存替身
+// 本文件不依赖Arduino头文件，主机端程序可以直接包含并链接nvs_storage.cpp
+class NvsStorage
+{
+public:
+    virtual ~NvsStorage() {}
+    virtual bool begin() = 0;
+    virtual size_t read(const char *key, void *buf, size_t len) = 0;
+    virtual size_t write(const char *key, const void *buf, size_t len) = 0;
+};
+
+// 内存替身：行为与NVS一致（读不到返回0），但不写Flash；只保存一条记录，键被忽略
+class MemoryNvs : public NvsStorage
+{
+private:
+    static const size_t CAPACITY = 32;
+    uint8_t data[CAPACITY];
+    size_t length;
+
+public:
+    MemoryNvs();
+    bool begin() override;
+    size_t read(const char *key, void *buf, size_t len) override;
+    size_t write(const char *key, const void *buf, size_t len) override;
+};
+
+#endif
@@ -0,0 +1,194 @@
+#include "offline_render.h"
+#include <lwip/sockets.h>
+#include "time_sync.h"
+#include "circadian.h"
+#include "spatial_effects.h"
+
+OfflineRenderer offlineRenderer;
+
+static const uint16_t RENDER_SEED = 1337;
+static const uint32_t RENDER_SECONDS_OF_DAY = 20 * 3600UL;   // 暖白类效果按晚上8点的色温和亮度渲染
+
+OfflineRenderer::OfflineRenderer()
+    : renderSeed(RENDER_SEED),
+      liveSeed(0),
+      sendOffset(0),
+      sendLength(0)
+{
+  memset(&stats, 0, sizeof(stats));
+}
+
+// 关闭、手动是静态画面，自动模式取决于人体传感器，时间轴和像素流依赖外部数据
+bool OfflineRenderer::supports(LightMode mode)
+{
+  return mode == MODE_BREATHE || mode == MODE_RAINBOW || mode == MODE_STARLIGHT ||
+         mode == MODE_SEGMENTS || mode == MODE_LAYERS;
+}
+
+bool OfflineRenderer::beginExport(const WiFiClient &target, LightMode mode, uint16_t fps, uint32_t frames)
+{
+  if (stats.running || !supports(mode) || fps == 0)
+    return false;
+  client = target;
+  stats.fps = fps;
+  stats.frames = 0;
+  stats.totalFrames = frames;
+  stats.running = true;
+  sendOffset = 0;
+  sendLength = 0;
+  renderSeed = RENDER_SEED;
+  enterRender();
+  start(mode, fps);
+  leaveRender();
+  return true;
+}
+
+bool OfflineRenderer::isExporting() const
+{
+  return stats.running;
+}
+
+// 每次最多占用RENDER_SLICE_US；套接字写不进去时提前让出，下次loop接着写
+void OfflineRenderer::loop()
+{
+  if (!stats.running)
+    return;
+  uint32_t sliceStart = micros();
+  do
+  {
+    if (sendOffset < sendLength && !flush())
+      return;
+    if (stats.frames >= stats.totalFrames)
+    {
+      endExport();
+      return;
+    }
+    sendOffset = 0;
+    sendLength = 0;
+    enterRender();
+    while (sendLength < sizeof(chunk) && stats.frames < stats.totalFrames)
+    {
+      memcpy(chunk + sendLength, nextFrame(), ROW_BYTES);
+      sendLength += ROW_BYTES;
+    }
+    leaveRender();
+  } while (micros() - sliceStart < Config::RENDER_SLICE_US);
+  flush();
+}
+
+// 切到渲染用的时钟、随机数和昼夜节律；leaveRender()原样还给实时效果
+void OfflineRenderer::enterRender()
+{
+  liveSeed = random16_get_seed();
+  random16_set_seed(renderSeed);
+  timeSync.setVirtualTime(stats.fps ? (uint64_t)stats.frames * 1000 / stats.fps : 0);
+  circadian.pin(RENDER_SECONDS_OF_DAY);
+}
+
+void OfflineRenderer::leaveRender()
+{
+  renderSeed = random16_get_seed();
+  random16_set_seed(liveSeed);
+  timeSync.clearVirtualTime();
+  circadian.unpin();
+}
+
+// 非阻塞写，与实时预览相同：写不完留到下次，对端关闭或出错时中止导出
+bool OfflineRenderer::flush()
+{
+  while (sendOffset < sendLength)
+  {
+    int n = send(client.fd(), chunk + sendOffset, sendLength - sendOffset, MSG_DONTWAIT);
+    if (n > 0)
+    {
+      sendOffset += n;
+    }
+    else
+    {
+      if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        return false;
+      endExport();
+      return false;
+    }
+  }
+  return true;
+}
+
+void OfflineRenderer::endExport()
+{
+  client.stop();
+  stats.running = false;
+  sendOffset = 0;
+  sendLength = 0;
+  Serial.printf("离线渲染 %s: %lu/%lu帧，渲染%lu帧/秒\n", MODE_NAMES[stats.mode],
+                (unsigned long)stats.frames, (unsigned long)stats.totalFrames, (unsigned long)framesPerSecond());
+}
+
+void OfflineRenderer::start(LightMode mode, uint16_t fps)
+{
+  stats.mode = mode;
+  stats.fps = fps;
+  stats.frames = 0;
+  stats.renderUs = 0;
+
+  CRGB *main = row;
+  CRGB *ring = row + Config::MAIN_NUM_LEDS;
+  if (mode == MODE_STARLIGHT)
+    starlight.begin(main, ring);
+  if (mode == MODE_SEGMENTS)
+    segments.parse(segmentCompositor.toString());
+  if (mode == MODE_LAYERS)
+  {
+    layers.parse(layerStack.toString());
+    layers.begin();
+  }
+}
+
+// 虚拟时间按帧号精确换算，帧率除不尽1000时也不累积误差
+const uint8_t *OfflineRenderer::nextFrame()
+{
+  uint32_t t = (uint64_t)stats.frames * 1000 / stats.fps;
+  timeSync.setVirtualTime(t);
+  CRGB *main = row;
+  CRGB *ring = row + Config::MAIN_NUM_LEDS;
+
+  uint32_t begin = micros();
+  switch (stats.mode)
+  {
+  case MODE_BREATHE:
+    renderBreathe(main, ring, (uint64_t)t * Config::BREATHE_FPS / 1000 % Config::BREATHE_STEPS);
+    break;
+  case MODE_RAINBOW:
+  {
+    uint8_t hue = (uint8_t)(t / Config::RAINBOW_HUE_STEP_MS);
+    fill_rainbow(main, Config::MAIN_NUM_LEDS, hue, 255 / Config::MAIN_NUM_LEDS);
+    fill_rainbow(ring, Config::RING_NUM_LEDS, hue + 64, 255 / Config::RING_NUM_LEDS);
+    break;
+  }
+  case MODE_STARLIGHT:
+    starlight.render();
+    break;
+  case MODE_SEGMENTS:
+    segments.render(main, ring, t);
+    break;
+  case MODE_LAYERS:
+    layers.render(main, ring, t);
+    break;
+  default:
+    fill_solid(row, PIXELS, CRGB::Black);
+    break;
+  }
+  stats.renderUs += micros() - begin;
+  stats.frames++;
+  return row->raw;
+}
+
+const OfflineRenderer::Stats &OfflineRenderer::getStats() const
+{
+  return stats;
+}
+
+uint32_t OfflineRenderer::framesPerSecond() const
+{
+  return stats.renderUs ? (uint64_t)stats.frames * 1000000 / stats.renderUs : 0;
+}
@@ -0,0 +1,69 @@
+#ifndef OFFLINE_RENDER_H
+#define OFFLINE_RENDER_H
+
+#include <Arduino.h>
+#include <FastLED.h>
+#include <WiFi.h>
+#include "config.h"
+#include "layers.h"
+#include "segments.h"
+#include "Breath_Starlight.h"
+
+/*
+离线渲染：在虚拟时钟上逐帧渲染某个模式，不等帧调度器、不刷新灯带，尽可能快地输出。
+每帧为一行RGB（主灯带在前，灯环在后），效果代码与实时显示相同；
+有状态的效果（星光、图层、分段）使用独立实例，导出开始时复制当前配置，不影响正在显示的内容。
+导出分片进行：主循环每次只渲染有限时间并非阻塞写入套接字，其余时间照常显示、处理命令和传感器。
+虚拟时钟、随机种子和固定的昼夜节律时刻只在分片内生效，分片结束即还给实时效果。
+*/
+class OfflineRenderer
+{
+public:
+  static const uint16_t PIXELS = Config::MAIN_NUM_LEDS + Config::RING_NUM_LEDS;
+  static const uint16_t ROW_BYTES = PIXELS * 3;
+
+  struct Stats
+  {
+    uint8_t mode;           // LightMode
+    uint16_t fps;           // 虚拟时钟的帧率
+    uint32_t frames;        // 已渲染的帧
+    uint32_t totalFrames;   // 本次导出的总帧数
+    uint32_t renderUs;      // 只计渲染，不含网络发送
+    bool running;
+  };
+
+  OfflineRenderer();
+  static bool supports(LightMode mode);
+  // 应答头已由调用方发出；之后的帧由loop()分片渲染写给client，写完关闭连接
+  bool beginExport(const WiFiClient &client, LightMode mode, uint16_t fps, uint32_t frames);
+  void loop();
+  bool isExporting() const;
+  const Stats &getStats() const;
+  uint32_t framesPerSecond() const;
+
+private:
+  static const uint8_t ROWS_PER_CHUNK = 8;    // 攒满若干行再发，减少小包
+
+  CRGB row[PIXELS];
+  BreathStarlight starlight;
+  LayerStack layers;
+  SegmentCompositor segments;
+  Stats stats;
+  WiFiClient client;
+  uint16_t renderSeed;                         // 渲染用的随机数状态，分片之间保存
+  uint16_t liveSeed;                           // 分片期间暂存的实时随机数状态
+  uint16_t sendOffset;
+  uint16_t sendLength;
+  uint8_t chunk[ROWS_PER_CHUNK * ROW_BYTES];
+
+  void start(LightMode mode, uint16_t fps);   // 虚拟时钟从0开始，随机种子和昼夜节律时刻固定，输出可复现
+  const uint8_t *nextFrame();
+  void enterRender();
+  void leaveRender();
+  bool flush();
+  void endExport();
+};
+
+extern OfflineRenderer offlineRenderer;
+
+#endif
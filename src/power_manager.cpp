@@ -0,0 +1,195 @@
+#include "power_manager.h"
+#include "config.h"
+#include "frame_scheduler.h"
+#include "wifi_manager.h"
+#include <WiFi.h>
+#include <esp_timer.h>
+#include <esp_sleep.h>
+#include <driver/gpio.h>
+
+PowerManager powerManager;
+
+PowerManager::PowerManager()
+    : idle(false),
+      lightSleepAllowed(true),
+      offSince(0),
+      idleSinceUs(0),
+      edgeUs(0),
+      wakeStartUs(0),
+      measuringWake(false),
+      wakeFrameBase(0),
+      stats()
+{
+}
+
+void PowerManager::loop(bool autoOff, uint32_t frameCount)
+{
+  unsigned long now = millis();
+
+  if (!autoOff)
+  {
+    // 未经过渲染首帧就离开自动熄灭（例如切到手动关闭），只恢复全速，不计唤醒延迟
+    if (idle)
+    {
+      wake();
+      measuringWake = false;
+    }
+    offSince = 0;
+  }
+  else if (!idle)
+  {
+    if (offSince == 0)
+      offSince = now ? now : 1;
+    else if (now - offSince >= Config::POWER_IDLE_DELAY_MS)
+      enterIdle();
+  }
+
+  // wake()之后出现的第一帧即为唤醒完成
+  if (measuringWake && frameCount != wakeFrameBase)
+  {
+    measuringWake = false;
+    uint32_t latency = (uint32_t)(esp_timer_get_time() - wakeStartUs);
+    stats.wakes++;
+    stats.lastWakeUs = latency;
+    if (latency > stats.maxWakeUs)
+      stats.maxWakeUs = latency;
+    if (latency > Config::WAKE_LATENCY_TARGET_MS * 1000UL)
+      stats.wakesOverTarget++;
+    wakeFrameBase = frameCount;
+  }
+  else if (!measuringWake)
+  {
+    wakeFrameBase = frameCount;
+  }
+
+  // WiFi离线等待重连期间没有网络请求，可以浅睡到下次重连
+  if (idle && lightSleepAllowed)
+  {
+    unsigned long remaining = wifiManager.retryRemainingMs();
+    if (remaining > Config::POWER_IDLE_POLL_MS)
+      lightSleep(remaining < Config::LIGHT_SLEEP_MAX_MS ? remaining : Config::LIGHT_SLEEP_MAX_MS);
+  }
+}
+
+void PowerManager::enterIdle()
+{
+  idle = true;
+  lightSleepAllowed = true;
+  idleSinceUs = esp_timer_get_time();
+  stats.idleEntries++;
+
+  // 灯带已在熄灭阶段输出全黑帧，之后不再刷新，数据线保持空闲低电平
+  setCpuFrequencyMhz(Config::IDLE_CPU_MHZ);
+  WiFi.setSleep(WIFI_PS_MAX_MODEM);
+  frameScheduler.setIdlePollMs(Config::POWER_IDLE_POLL_MS);
+}
+
+void PowerManager::wake()
+{
+  if (!idle)
+    return;
+  idle = false;
+  offSince = 0;
+
+  int64_t now = esp_timer_get_time();
+  stats.idleUs += now - idleSinceUs;
+
+  setCpuFrequencyMhz(Config::ACTIVE_CPU_MHZ);
+  WiFi.setSleep(WIFI_PS_MIN_MODEM);
+  frameScheduler.setIdlePollMs(Config::IDLE_POLL_MS);
+
+  // 待机期间的人体触发从电平变化算起，其余（网页、像素流）从此刻算起
+  int64_t edge = edgeUs;
+  wakeStartUs = edge > idleSinceUs ? edge : now;
+  measuringWake = true;
+}
+
+void IRAM_ATTR PowerManager::noteEdgeFromISR()
+{
+  edgeUs = esp_timer_get_time();
+}
+
+void PowerManager::lightSleep(uint32_t ms)
+{
+  // 传感器当前电平的反相作为唤醒条件
+  gpio_num_t pin = (gpio_num_t)Config::MOTION_SENSOR_PIN;
+  gpio_wakeup_enable(pin, digitalRead(Config::MOTION_SENSOR_PIN) ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL);
+  esp_sleep_enable_gpio_wakeup();
+  esp_sleep_enable_timer_wakeup((uint64_t)ms * 1000);
+
+  Serial.flush();
+  int64_t start = esp_timer_get_time();
+  bool slept = esp_light_sleep_start() == 0;
+  int64_t end = esp_timer_get_time();
+  // gpio_wakeup_enable把引脚中断改成了电平触发，gpio_wakeup_disable不会改回；
+  // 恢复attachInterrupt(CHANGE)时的双边沿触发，否则之后的边沿中断失效或不停重入
+  gpio_wakeup_disable(pin);
+  gpio_set_intr_type(pin, GPIO_INTR_ANYEDGE);
+
+  if (!slept)
+  {
+    lightSleepAllowed = false;
+    return;
+  }
+  stats.lightSleeps++;
+  stats.lightSleepUs += end - start;
+
+  // 浅睡中GPIO中断不会触发，由唤醒原因补记电平变化时间
+  if (esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_GPIO)
+  {
+    edgeUs = end;
+    frameScheduler.notify();
+  }
+}
+
+bool PowerManager::isIdle() const
+{
+  return idle;
+}
+
+PowerManager::Stats PowerManager::getStats() const
+{
+  Stats s = stats;
+  s.idle = idle;
+  s.cpuMhz = getCpuFrequencyMhz();
+  if (idle)
+    s.idleUs += esp_timer_get_time() - idleSinceUs;
+  return s;
+}
+
+size_t PowerManager::renderMetrics(char *out, size_t cap) const
+{
+  if (cap == 0)
+    return 0;
+  Stats s = getStats();
+  int n = snprintf(out, cap,
+                   "# HELP led_power_idle Whether the low-power idle mode is active.\n"
+                   "# TYPE led_power_idle gauge\n"
+                   "led_power_idle %u\n"
+                   "# HELP led_cpu_frequency_mhz Current CPU clock.\n"
+                   "# TYPE led_cpu_frequency_mhz gauge\n"
+                   "led_cpu_frequency_mhz %lu\n"
+                   "# HELP led_power_idle_seconds_total Time spent in low-power idle.\n"
+                   "# TYPE led_power_idle_seconds_total counter\n"
+                   "led_power_idle_seconds_total %lu\n"
+                   "# HELP led_light_sleep_seconds_total Time spent in light sleep while Wi-Fi was offline.\n"
+                   "# TYPE led_light_sleep_seconds_total counter\n"
+                   "led_light_sleep_seconds_total %lu\n"
+                   "# HELP led_wake_latency_last_seconds Last idle wake to first frame.\n"
+                   "# TYPE led_wake_latency_last_seconds gauge\n"
+                   "led_wake_latency_last_seconds %lu.%06lu\n"
+                   "# HELP led_wake_latency_max_seconds Slowest idle wake to first frame.\n"
+                   "# TYPE led_wake_latency_max_seconds gauge\n"
+                   "led_wake_latency_max_seconds %lu.%06lu\n"
+                   "# HELP led_wakes_over_target_total Wakes slower than the latency target.\n"
+                   "# TYPE led_wakes_over_target_total counter\n"
+                   "led_wakes_over_target_total %lu\n",
+                   s.idle ? 1 : 0, (unsigned long)s.cpuMhz,
+                   (unsigned long)(s.idleUs / 1000000), (unsigned long)(s.lightSleepUs / 1000000),
+                   (unsigned long)(s.lastWakeUs / 1000000), (unsigned long)(s.lastWakeUs % 1000000),
+                   (unsigned long)(s.maxWakeUs / 1000000), (unsigned long)(s.maxWakeUs % 1000000),
+                   (unsigned long)s.wakesOverTarget);
+  if (n < 0)
+    return 0;
+  return (size_t)n < cap ? n : cap - 1;
+}
@@ -0,0 +1,52 @@
+#ifndef POWER_MANAGER_H
+#define POWER_MANAGER_H
+
+#include <Arduino.h>
+
+// 低功耗待机：自动模式熄灭一段时间后降主频、WiFi改为深度调制解调器睡眠并放慢轮询；
+// WiFi离线等待重连时进一步浅睡。人体传感器中断或网络请求唤醒，记录唤醒到首帧的延迟
+class PowerManager
+{
+public:
+  struct Stats
+  {
+    bool idle;
+    uint32_t cpuMhz;
+    uint32_t idleEntries;
+    uint64_t idleUs;           // 累计待机时间
+    uint32_t lightSleeps;
+    uint64_t lightSleepUs;     // 累计浅睡时间
+    uint32_t wakes;            // 已测量的唤醒次数
+    uint32_t lastWakeUs;       // 最近一次唤醒到首帧
+    uint32_t maxWakeUs;
+    uint32_t wakesOverTarget;
+  };
+
+  PowerManager();
+
+  void loop(bool autoOff, uint32_t frameCount);  // 每次loop调用
+  void wake();                                   // 离开熄灭阶段时由控制器调用，渲染首帧之前恢复全速
+  void noteEdgeFromISR();                        // 人体传感器电平变化时间
+
+  bool isIdle() const;
+  Stats getStats() const;
+  size_t renderMetrics(char *out, size_t cap) const;
+
+private:
+  bool idle;
+  bool lightSleepAllowed;        // 浅睡被拒绝后本次待机不再尝试
+  unsigned long offSince;        // 进入自动熄灭的时间
+  int64_t idleSinceUs;
+  volatile int64_t edgeUs;       // ISR写入
+  int64_t wakeStartUs;
+  bool measuringWake;
+  uint32_t wakeFrameBase;
+  Stats stats;
+
+  void enterIdle();
+  void lightSleep(uint32_t ms);
+};
+
+extern PowerManager powerManager;
+
+#endif
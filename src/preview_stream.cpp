@@ -0,0 +1,378 @@
+#include "preview_stream.h"
+#include <lwip/sockets.h>
+#include "geometry.h"
+#include "metrics.h"
+
+PreviewStream previewStream;
+
+static const char RESPONSE_HEADER[] =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: application/octet-stream\r\n"
+    "Cache-Control: no-cache\r\n"
+    "Access-Control-Allow-Origin: *\r\n"
+    "Connection: close\r\n\r\n";
+
+static_assert(sizeof(RESPONSE_HEADER) - 1 <= 192, "response header must fit in front of the first frame");
+
+PreviewStream::PreviewStream()
+    : server(Config::PREVIEW_PORT),
+      mainLeds(nullptr),
+      ringLeds(nullptr),
+      requestDone(false),
+      lineComplete(false),
+      fps(Config::PREVIEW_FPS),
+      sentBrightness(0),
+      seq(0),
+      requestTail(0),
+      lineLength(0),
+      connectedAt(0),
+      lastFrame(0),
+      sendOffset(0),
+      sendLength(0)
+{
+  memset(&stats, 0, sizeof(stats));
+  requestLine[0] = '\0';
+}
+
+void PreviewStream::begin(const CRGB *main, const CRGB *ring)
+{
+  mainLeds = main;
+  ringLeds = ring;
+}
+
+void PreviewStream::beginServer()
+{
+  server.begin();
+  server.setNoDelay(true);
+}
+
+bool PreviewStream::isConnected()
+{
+  return requestDone && client.connected();
+}
+
+uint8_t PreviewStream::getFps() const
+{
+  return fps;
+}
+
+const PreviewStream::Stats &PreviewStream::getStats() const
+{
+  return stats;
+}
+
+const CRGB &PreviewStream::pixel(uint16_t i) const
+{
+  return i < Config::MAIN_NUM_LEDS ? mainLeds[i] : ringLeds[i - Config::MAIN_NUM_LEDS];
+}
+
+// 只服务一个预览端，新连接顶替旧连接
+void PreviewStream::acceptClient()
+{
+  if (!server.hasClient())
+    return;
+  disconnect();
+  client = server.accept();
+  client.setNoDelay(true);
+  connectedAt = millis();
+  stats.clients++;
+}
+
+void PreviewStream::disconnect()
+{
+  if (client)
+    client.stop();
+  requestDone = false;
+  requestTail = 0;
+  lineComplete = false;
+  lineLength = 0;
+  requestLine[0] = '\0';
+  sendOffset = 0;
+  sendLength = 0;
+}
+
+// 只读已到达的字节：保存请求行取fps参数，读到空行即开始推送
+void PreviewStream::readRequest()
+{
+  while (client.available() > 0)
+  {
+    int c = client.read();
+    if (c < 0)
+      break;
+    if (c == '\n')
+      lineComplete = true;
+    else if (!lineComplete && c != '\r' && lineLength < sizeof(requestLine) - 1)
+    {
+      requestLine[lineLength++] = c;
+      requestLine[lineLength] = '\0';
+    }
+    requestTail = (requestTail << 8) | (uint8_t)c;
+    if (requestTail == 0x0D0A0D0A || (requestTail & 0xFFFF) == 0x0A0A)
+    {
+      startStream();
+      return;
+    }
+  }
+}
+
+void PreviewStream::startStream()
+{
+  const char *arg = strstr(requestLine, "fps=");
+  int requested = arg ? atoi(arg + 4) : Config::PREVIEW_FPS;
+  fps = constrain(requested, 1, (int)Config::PREVIEW_MAX_FPS);
+
+  requestDone = true;
+  uint16_t headerLength = sizeof(RESPONSE_HEADER) - 1;
+  memcpy(buffer, RESPONSE_HEADER, headerLength);
+  sendOffset = 0;
+  sendLength = headerLength + encode(buffer + headerLength, true);
+  stats.frames++;
+  lastFrame = millis();
+  flush();
+}
+
+// 非阻塞写：写不完的部分留到下次loop，对端关闭或出错时断开
+bool PreviewStream::flush()
+{
+  while (sendOffset < sendLength)
+  {
+    int n = send(client.fd(), buffer + sendOffset, sendLength - sendOffset, MSG_DONTWAIT);
+    if (n > 0)
+    {
+      sendOffset += n;
+      stats.bytes += n;
+    }
+    else
+    {
+      if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        return false;
+      disconnect();
+      return false;
+    }
+  }
+  return true;
+}
+
+void PreviewStream::loop(uint32_t nowMs)
+{
+  acceptClient();
+  if (!client)
+    return;
+  if (!requestDone)
+  {
+    readRequest();
+    if (!requestDone && nowMs - connectedAt > Config::PREVIEW_REQUEST_TIMEOUT_MS)
+      disconnect();
+    return;
+  }
+
+  flush();
+  if (nowMs - lastFrame < 1000u / fps)
+    return;
+  lastFrame = nowMs;
+  if (!client.connected())
+  {
+    disconnect();
+    return;
+  }
+  if (sendOffset < sendLength)
+  {
+    stats.dropped++;
+    return;
+  }
+
+  uint32_t start = micros();
+  uint16_t length = encode(buffer, false);
+  uint32_t us = micros() - start;
+  stats.lastEncodeUs = us;
+  if (us > stats.maxEncodeUs)
+    stats.maxEncodeUs = us;
+  metrics.previewEncodeTime.observe(us);
+  if (length == 0)
+  {
+    stats.unchanged++;
+    return;
+  }
+  stats.frames++;
+  sendOffset = 0;
+  sendLength = length;
+  flush();
+}
+
+uint16_t PreviewStream::encode(uint8_t *out, bool keyframe)
+{
+  uint8_t brightness = FastLED.getBrightness();
+  uint8_t *p = out + HEADER_SIZE;
+  const uint8_t *limit = out + FRAME_CAPACITY;
+
+  if (!keyframe)
+  {
+    uint16_t last = 0;
+    uint16_t i = 0;
+    while (i < PIXELS && !keyframe)
+    {
+      if (pixel(i) == sent[i])
+      {
+        i++;
+        continue;
+      }
+      uint16_t end = i;
+      while (end < PIXELS && !(pixel(end) == sent[end]))
+        end++;
+
+      // 变化区间[i, end)：连续相同颜色编为重复段，其余编为原样段
+      uint16_t skip = i - last;
+      while (i < end)
+      {
+        uint16_t run = 1;
+        while (i + run < end && run < 127 && pixel(i + run) == pixel(i))
+          run++;
+        bool repeat = run >= 2;
+        if (!repeat)
+        {
+          while (i + run < end && run < 127 && !(i + run + 1 < end && pixel(i + run) == pixel(i + run + 1)))
+            run++;
+        }
+        uint16_t need = (skip / 255 + 1) * 2 + (repeat ? 3 : run * 3);
+        if (p + need > limit)
+        {
+          keyframe = true;
+          break;
+        }
+        for (; skip > 255; skip -= 255)
+        {
+          *p++ = 255;
+          *p++ = 0;
+        }
+        *p++ = skip;
+        *p++ = repeat ? (0x80 | run) : run;
+        for (uint16_t k = 0; k < (repeat ? 1 : run); k++)
+        {
+          const CRGB &c = pixel(i + k);
+          *p++ = c.r;
+          *p++ = c.g;
+          *p++ = c.b;
+        }
+        skip = 0;
+        i += run;
+      }
+      last = end;
+    }
+    if (!keyframe && p == out + HEADER_SIZE && brightness == sentBrightness)
+      return 0;
+  }
+
+  if (keyframe)
+  {
+    p = out + HEADER_SIZE;
+    memcpy(p, mainLeds, Config::MAIN_NUM_LEDS * 3);
+    memcpy(p + Config::MAIN_NUM_LEDS * 3, ringLeds, Config::RING_NUM_LEDS * 3);
+    p += PIXELS * 3;
+    stats.keyframes++;
+  }
+
+  memcpy(sent, mainLeds, Config::MAIN_NUM_LEDS * 3);
+  memcpy(sent + Config::MAIN_NUM_LEDS, ringLeds, Config::RING_NUM_LEDS * 3);
+  sentBrightness = brightness;
+
+  uint16_t payload = p - out - HEADER_SIZE;
+  out[0] = keyframe ? 'K' : 'D';
+  out[1] = brightness;
+  out[2] = seq & 0xFF;
+  out[3] = seq >> 8;
+  out[4] = payload & 0xFF;
+  out[5] = payload >> 8;
+  seq++;
+  stats.lastFrameBytes = HEADER_SIZE + payload;
+  return HEADER_SIZE + payload;
+}
+
+// 灯珠按几何映射的x/y摆放，帧按上面的格式在浏览器里解码
+String PreviewStream::viewerPage() const
+{
+  String coords;
+  for (uint16_t i = 0; i < PIXELS; i++)
+  {
+    const PixelCoord &c = i < Config::MAIN_NUM_LEDS ? GEOMETRY.main[i] : GEOMETRY.ring[i - Config::MAIN_NUM_LEDS];
+    coords += String(i ? "," : "") + c.x + "," + c.y;
+  }
+  String html = R"rawliteral(<!DOCTYPE HTML>
+<html>
+<head>
+  <meta name="viewport" content="width=device-width, initial-scale=1">
+  <meta charset='UTF-8'>
+  <title>实时预览</title>
+  <style>
+    body { background: #111; color: #aaa; font-family: Arial; text-align: center; }
+    canvas { width: 100%; max-width: 800px; background: #000; }
+  </style>
+</head>
+<body>
+  <canvas id="view" width="800" height="260"></canvas>
+  <p id="info">连接中...</p>
+  <script>
+    const XY = [)rawliteral" + coords + R"rawliteral(];
+    const N = XY.length / 2;
+    const px = new Uint8Array(N * 3);
+    const ctx = document.getElementById('view').getContext('2d');
+    let frames = 0, bytes = 0;
+
+    function draw(brightness) {
+      ctx.fillStyle = '#000';
+      ctx.fillRect(0, 0, 800, 260);
+      const s = Math.max(brightness, 1) / 255;
+      for (let i = 0; i < N; i++) {
+        ctx.fillStyle = `rgb(${px[i*3]*s|0},${px[i*3+1]*s|0},${px[i*3+2]*s|0})`;
+        ctx.beginPath();
+        ctx.arc(10 + XY[i*2] * 3, 250 - XY[i*2+1] * 3, 5, 0, 2 * Math.PI);
+        ctx.fill();
+      }
+    }
+
+    function decode(b) {
+      const n = b[4] | (b[5] << 8);
+      if (b[0] === 75) {
+        px.set(b.subarray(6, 6 + n));
+      } else {
+        let i = 0, k = 6;
+        while (k < 6 + n) {
+          i += b[k++];
+          const op = b[k++];
+          const count = op & 0x7F;
+          for (let j = 0; j < count; j++, i++) {
+            const src = (op & 0x80) ? k : k + j * 3;
+            px[i*3] = b[src]; px[i*3+1] = b[src+1]; px[i*3+2] = b[src+2];
+          }
+          k += (op & 0x80) ? 3 : count * 3;
+        }
+      }
+      draw(b[1]);
+      return 6 + n;
+    }
+
+    const fps = new URLSearchParams(location.search).get('fps') || )rawliteral" + String(Config::PREVIEW_FPS) + R"rawliteral(;
+    fetch('http://' + location.hostname + ':)rawliteral" + String(Config::PREVIEW_PORT) + R"rawliteral(/?fps=' + fps).then(async response => {
+      const reader = response.body.getReader();
+      let buf = new Uint8Array(0);
+      for (;;) {
+        const { value, done } = await reader.read();
+        if (done) break;
+        const joined = new Uint8Array(buf.length + value.length);
+        joined.set(buf);
+        joined.set(value, buf.length);
+        buf = joined;
+        bytes += value.length;
+        while (buf.length >= 6 && buf.length >= 6 + (buf[4] | (buf[5] << 8))) {
+          buf = buf.subarray(decode(buf));
+          frames++;
+        }
+        document.getElementById('info').innerText = `${frames} 帧，平均 ${(bytes / Math.max(frames, 1)).toFixed(0)} 字节/帧`;
+      }
+      document.getElementById('info').innerText = '连接已断开（可能被新的预览页顶替）';
+    });
+  </script>
+</body>
+</html>
+)rawliteral";
+  return html;
+}
@@ -0,0 +1,79 @@
+#ifndef PREVIEW_STREAM_H
+#define PREVIEW_STREAM_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include "config.h"
+
+/*
+实时预览：浏览器连接端口81后，按设定帧率推送mainLeds/ringLeds的内容（主灯带在前，灯环在后）。
+每帧头6字节：类型('K'全帧/'D'差分)、全局亮度、序号u16、负载长度u16（小端）。
+全帧负载为全部像素RGB；差分负载为若干 [跳过数][操作][数据]，操作最高位为1时表示
+(操作&0x7F)个相同颜色的像素，后跟一个RGB，否则表示后跟相应个数的RGB。差分不比全帧小时改发全帧。
+发送不阻塞：上一帧还没写进套接字时直接丢弃新帧，差分始终相对最后一次发出的帧。
+*/
+class PreviewStream
+{
+public:
+  struct Stats
+  {
+    uint32_t clients;       // 累计接入的客户端
+    uint32_t frames;        // 已编码并排队发送的帧
+    uint32_t keyframes;
+    uint32_t dropped;       // 因客户端太慢被丢弃的帧
+    uint32_t unchanged;     // 内容与上一帧相同而跳过的帧
+    uint32_t bytes;         // 实际写入套接字的字节数
+    uint32_t lastEncodeUs;
+    uint32_t maxEncodeUs;
+    uint16_t lastFrameBytes;
+  };
+
+  PreviewStream();
+  void begin(const CRGB *main, const CRGB *ring);
+  void beginServer();                     // 网络栈初始化后调用
+  void loop(uint32_t nowMs);
+  bool isConnected();
+  uint8_t getFps() const;
+  const Stats &getStats() const;
+  String viewerPage() const;              // 端口80上的预览页，按几何坐标绘制灯珠
+
+  // 把当前内容相对上一次发出的帧编码到out，返回字节数（含帧头）
+  uint16_t encode(uint8_t *out, bool keyframe);
+
+private:
+  static const uint16_t PIXELS = Config::MAIN_NUM_LEDS + Config::RING_NUM_LEDS;
+  static const uint8_t HEADER_SIZE = 6;
+  static const uint16_t FRAME_CAPACITY = HEADER_SIZE + PIXELS * 3;
+  static const uint16_t BUFFER_SIZE = 192 + FRAME_CAPACITY;  // 首帧前还要放HTTP应答头
+
+  WiFiServer server;
+  WiFiClient client;
+  const CRGB *mainLeds;
+  const CRGB *ringLeds;
+  bool requestDone;
+  bool lineComplete;                      // 请求行已读完，之后的请求头只用来找空行
+  uint8_t fps;
+  uint8_t sentBrightness;
+  uint16_t seq;
+  uint32_t requestTail;                   // 最近收到的4个字节，用于找空行
+  uint16_t lineLength;
+  char requestLine[64];
+  unsigned long connectedAt;
+  unsigned long lastFrame;
+  uint16_t sendOffset;
+  uint16_t sendLength;
+  uint8_t buffer[BUFFER_SIZE];
+  CRGB sent[PIXELS];                      // 最后一次发出的帧
+  Stats stats;
+
+  const CRGB &pixel(uint16_t i) const;
+  void acceptClient();
+  void readRequest();
+  void startStream();
+  bool flush();
+  void disconnect();
+};
+
+extern PreviewStream previewStream;
+
+#endif
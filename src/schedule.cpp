@@ -0,0 +1,171 @@
+#include "schedule.h"
+#include "command_queue.h"
+#include "binary_log.h"
+#include "LED_Controller.h"
+
+ModeSchedule modeSchedule;
+
+static const uint32_t SECONDS_PER_DAY = 86400;
+
+ModeSchedule::ModeSchedule()
+    : clock(nullptr),
+      entryCount(0),
+      epoch(0),
+      needRebuild(true)
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+void ModeSchedule::begin(ClockSource *clockSource)
+{
+    clock = clockSource;
+    needRebuild = true;
+}
+
+// 平时只比较堆顶一次；到期时弹出、投递命令，再按墙上时间算出明天的触发时刻放回堆中
+void ModeSchedule::loop(uint32_t nowMs)
+{
+    // 时间来源切换或校时状态变化：按新时间重建整个堆
+    if (clock == nullptr && circadian.getClockEpoch() != epoch)
+    {
+        epoch = circadian.getClockEpoch();
+        needRebuild = true;
+    }
+    if (needRebuild)
+        rebuild(nowMs);
+
+    while (!timers.empty() && (int32_t)(timers.top().dueMs - nowMs) <= 0)
+    {
+        TimerHeap::Timer timer = timers.top();
+        timers.pop();
+        const Entry &entry = entries[timer.id];
+        if (commandQueue.push(Command{CMD_SET_MODE, entry.mode, 0, 0}))
+        {
+            stats.fired++;
+            BINLOG(SCHEDULE_FIRE, entry.minute, entry.mode);
+        }
+        else
+        {
+            stats.dropped++;
+        }
+        // millis可能比墙上时间略快，刚触发的表项至少推到一分钟之后，即明天
+        uint32_t seconds = source()->secondsOfDay();
+        uint32_t delay = msUntil(entry.minute, seconds);
+        if (delay < 60000)
+            delay += SECONDS_PER_DAY * 1000;
+        timers.push(nowMs + delay, timer.id);
+    }
+}
+
+// 表项数量有限，按分钟插入排序；同一分钟只能有一项
+// 堆里存的是表项下标，换表后立即重建，避免nextEntry()在下一次loop()前读到旧下标
+bool ModeSchedule::setEntries(const Entry *list, uint8_t count)
+{
+    if (count > MAX_ENTRIES)
+        return false;
+    Entry sorted[MAX_ENTRIES];
+    for (uint8_t i = 0; i < count; i++)
+    {
+        if (list[i].minute >= 24 * 60 || list[i].mode >= MODE_COUNT)
+            return false;
+        uint8_t j = i;
+        while (j > 0 && sorted[j - 1].minute > list[i].minute)
+        {
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+        if (j > 0 && sorted[j - 1].minute == list[i].minute)
+            return false;
+        sorted[j] = list[i];
+    }
+    memcpy(entries, sorted, count * sizeof(Entry));
+    entryCount = count;
+    rebuild(millis());
+    return true;
+}
+
+bool ModeSchedule::parse(const String &text)
+{
+    Entry list[MAX_ENTRIES];
+    uint8_t count = 0;
+    const char *p = text.c_str();
+    while (*p)
+    {
+        unsigned hour, minute;
+        char name[16];
+        int used = 0;
+        if (count >= MAX_ENTRIES || sscanf(p, "%u:%u=%15[a-z]%n", &hour, &minute, name, &used) != 3)
+            return false;
+        LightMode mode;
+        if (hour >= 24 || minute >= 60 || !LEDController::parseMode(String(name), mode))
+            return false;
+        list[count++] = Entry{(uint16_t)(hour * 60 + minute), (uint8_t)mode};
+        p += used;
+        if (*p == ';')
+            p++;
+        else if (*p)
+            return false;
+    }
+    return setEntries(list, count);
+}
+
+String ModeSchedule::toString() const
+{
+    String text;
+    char time[8];
+    for (uint8_t i = 0; i < entryCount; i++)
+    {
+        if (i > 0)
+            text += ';';
+        snprintf(time, sizeof(time), "%02u:%02u=", entries[i].minute / 60, entries[i].minute % 60);
+        text += time;
+        text += LEDController::modeName((LightMode)entries[i].mode);
+    }
+    return text;
+}
+
+uint8_t ModeSchedule::getEntryCount() const
+{
+    return entryCount;
+}
+
+bool ModeSchedule::nextEntry(Entry &entry, uint32_t &inMs, uint32_t nowMs) const
+{
+    if (timers.empty())
+        return false;
+    entry = entries[timers.top().id];
+    int32_t remaining = (int32_t)(timers.top().dueMs - nowMs);
+    inMs = remaining > 0 ? remaining : 0;
+    return true;
+}
+
+const ModeSchedule::Stats &ModeSchedule::getStats() const
+{
+    return stats;
+}
+
+ClockSource *ModeSchedule::source() const
+{
+    return clock ? clock : circadian.getClock();
+}
+
+// 从secondsOfDay到当天（或明天）minute整点的毫秒数，0-24小时
+uint32_t ModeSchedule::msUntil(uint16_t minute, uint32_t secondsOfDay) const
+{
+    uint32_t target = minute * 60UL;
+    return ((target + SECONDS_PER_DAY - secondsOfDay) % SECONDS_PER_DAY) * 1000;
+}
+
+// 未校时不排任何触发，校时完成后epoch变化会再次重建
+void ModeSchedule::rebuild(uint32_t nowMs)
+{
+    needRebuild = false;
+    timers.clear();
+    stats.rebuilds++;
+    ClockSource *src = source();
+    if (!src->valid())
+        return;
+    uint32_t seconds = src->secondsOfDay();
+    for (uint8_t i = 0; i < entryCount; i++)
+        timers.push(nowMs + msUntil(entries[i].minute, seconds), i);
+}
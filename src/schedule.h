@@ -0,0 +1,56 @@
+#ifndef SCHEDULE_H
+#define SCHEDULE_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "circadian.h"
+#include "timer_heap.h"
+
+// 日程：每天固定时刻切换模式。表项按时刻存放，各表项的下一次触发时间（millis）放在最小堆里，
+// 主循环每次只看堆顶，到期后经命令队列走与网页相同的setMode()路径
+class ModeSchedule
+{
+public:
+    struct Entry
+    {
+        uint16_t minute;         // 当天第几分钟
+        uint8_t mode;            // LightMode
+    };
+
+    struct Stats
+    {
+        uint32_t fired;
+        uint32_t dropped;        // 命令队列满而丢弃的触发
+        uint32_t rebuilds;
+    };
+
+    static const uint8_t MAX_ENTRIES = TimerHeap::CAPACITY;
+
+    ModeSchedule();
+    // clock为空时与昼夜节律共用时间来源（/circadian?time= 切换也对日程生效）
+    void begin(ClockSource *clock = nullptr);
+    void loop(uint32_t nowMs);
+    bool setEntries(const Entry *entries, uint8_t count);
+    bool parse(const String &text);              // "HH:MM=模式;..."，空串清空日程
+    String toString() const;
+    uint8_t getEntryCount() const;
+    bool nextEntry(Entry &entry, uint32_t &inMs, uint32_t nowMs) const;
+    const Stats &getStats() const;
+
+private:
+    ClockSource *clock;
+    Entry entries[MAX_ENTRIES];
+    uint8_t entryCount;
+    TimerHeap timers;            // 各表项的下一次触发时间，编号为表项下标
+    uint16_t epoch;
+    bool needRebuild;
+    Stats stats;
+
+    ClockSource *source() const;
+    uint32_t msUntil(uint16_t minute, uint32_t secondsOfDay) const;
+    void rebuild(uint32_t nowMs);
+};
+
+extern ModeSchedule modeSchedule;
+
+#endif
@@ -0,0 +1,195 @@
+#include "segments.h"
+#include "easing.h"
+#include "natural_light.h"
+#include "circadian.h"
+#include "text_util.h"
+
+namespace
+{
+  const char *const STRIP_NAMES[STRIP_COUNT] = {"main", "ring"};
+  const uint8_t STRIP_LENGTH[STRIP_COUNT] = {Config::MAIN_NUM_LEDS, Config::RING_NUM_LEDS};
+  const char *const EFFECT_NAMES[SEG_EFFECT_COUNT] = {"solid", "rainbow", "breathe", "chase", "natural"};
+
+  static_assert(Config::MAIN_NUM_LEDS >= Config::RING_NUM_LEDS, "scratch buffer is sized for the main strip");
+
+  // 周期内的相位，0-255
+  inline uint8_t phase8(uint32_t nowMs, uint16_t periodMs)
+  {
+    return (uint8_t)((nowMs % periodMs) * 256 / periodMs);
+  }
+
+  void renderSolid(CRGB *out, uint8_t count, const Segment &seg, uint32_t)
+  {
+    fill_solid(out, count, seg.color);
+  }
+
+  void renderRainbow(CRGB *out, uint8_t count, const Segment &seg, uint32_t nowMs)
+  {
+    fill_rainbow(out, count, phase8(nowMs, seg.periodMs), 255 / count);
+  }
+
+  void renderBreathe(CRGB *out, uint8_t count, const Segment &seg, uint32_t nowMs)
+  {
+    CRGB c = seg.color;
+    c.nscale8_video(ease8(CURVE_SINE, triwave8(phase8(nowMs, seg.periodMs))));
+    fill_solid(out, count, c);
+  }
+
+  // 一个亮点带三格拖尾，每个周期从段首跑到段尾
+  void renderChase(CRGB *out, uint8_t count, const Segment &seg, uint32_t nowMs)
+  {
+    fill_solid(out, count, CRGB::Black);
+    uint8_t head = ((uint16_t)phase8(nowMs, seg.periodMs) * count) >> 8;
+    for (uint8_t k = 0; k < 4 && k < count; k++)
+    {
+      CRGB c = seg.color;
+      out[(head + count - k) % count] = c.nscale8(255 >> (2 * k));
+    }
+  }
+
+  // 色温两端取自昼夜节律，周期参数不使用
+  void renderNatural(CRGB *out, uint8_t count, const Segment &, uint32_t nowMs)
+  {
+    NaturalLight light;
+    light.configure(circadian.warmWhite(255, -300), circadian.warmWhite(255, 600));
+    light.render(out, count, nowMs);
+  }
+
+  typedef void (*SegmentRender)(CRGB *out, uint8_t count, const Segment &seg, uint32_t nowMs);
+
+  const SegmentRender RENDERERS[SEG_EFFECT_COUNT] = {
+      renderSolid, renderRainbow, renderBreathe, renderChase, renderNatural};
+
+  // 默认布局：主灯带三段（自然光、镜像追光、反向彩虹），灯环整体呼吸
+  const Segment DEFAULT_SEGMENTS[] = {
+      {STRIP_MAIN, 0, 20, 0, SEG_NATURAL, CRGB::Black, 1000},
+      {STRIP_MAIN, 20, 20, SEG_MIRROR, SEG_CHASE, CRGB(255, 120, 40), 1500},
+      {STRIP_MAIN, 40, 20, SEG_REVERSE, SEG_RAINBOW, CRGB::Black, 6000},
+      {STRIP_RING, 0, Config::RING_NUM_LEDS, 0, SEG_BREATHE, CRGB(255, 160, 80), 4000},
+  };
+}
+
+// 构造时用到上面的默认布局，须定义在其后
+SegmentCompositor segmentCompositor;
+
+SegmentCompositor::SegmentCompositor()
+    : count(0)
+{
+  setSegments(DEFAULT_SEGMENTS, sizeof(DEFAULT_SEGMENTS) / sizeof(DEFAULT_SEGMENTS[0]));
+}
+
+// 段必须落在灯带范围内、周期至少100ms，否则保持原布局
+bool SegmentCompositor::setSegments(const Segment *list, uint8_t n)
+{
+  if (n > MAX_SEGMENTS)
+    return false;
+  for (uint8_t i = 0; i < n; i++)
+  {
+    const Segment &seg = list[i];
+    if (seg.strip >= STRIP_COUNT || seg.effect >= SEG_EFFECT_COUNT || seg.length == 0 ||
+        seg.start + seg.length > STRIP_LENGTH[seg.strip] || seg.periodMs < 100)
+      return false;
+  }
+  memcpy(segments, list, n * sizeof(Segment));
+  count = n;
+  return true;
+}
+
+bool SegmentCompositor::parse(const String &text)
+{
+  Segment list[MAX_SEGMENTS];
+  uint8_t n = 0;
+  const char *p = text.c_str();
+  while (*p)
+  {
+    char strip[8], flags[4], effect[12];
+    unsigned start, length, rgb, period;
+    int used = 0;
+    if (n >= MAX_SEGMENTS ||
+        sscanf(p, "%7[a-z],%u,%u,%3[-rm],%11[a-z],%6x,%u%n", strip, &start, &length, flags, effect, &rgb, &period, &used) != 7)
+      return false;
+    int8_t stripId = findName(STRIP_NAMES, STRIP_COUNT, strip);
+    int8_t effectId = findName(EFFECT_NAMES, SEG_EFFECT_COUNT, effect);
+    if (stripId < 0 || effectId < 0 || start > 255 || length > 255 || period > 65535)
+      return false;
+    uint8_t flagBits = (strchr(flags, 'r') ? SEG_REVERSE : 0) | (strchr(flags, 'm') ? SEG_MIRROR : 0);
+    list[n++] = Segment{(uint8_t)stripId, (uint8_t)start, (uint8_t)length, flagBits, (uint8_t)effectId,
+                        CRGB((rgb >> 16) & 0xFF, (rgb >> 8) & 0xFF, rgb & 0xFF), (uint16_t)period};
+    p += used;
+    if (*p == ';')
+      p++;
+    else if (*p)
+      return false;
+  }
+  return setSegments(list, n);
+}
+
+String SegmentCompositor::toString() const
+{
+  String text;
+  char item[48];
+  for (uint8_t i = 0; i < count; i++)
+  {
+    const Segment &seg = segments[i];
+    const char *flags = seg.flags == (SEG_REVERSE | SEG_MIRROR) ? "rm" : seg.flags & SEG_REVERSE ? "r" : seg.flags & SEG_MIRROR ? "m" : "-";
+    snprintf(item, sizeof(item), "%s%s,%u,%u,%s,%s,%02x%02x%02x,%u", i ? ";" : "",
+             STRIP_NAMES[seg.strip], seg.start, seg.length, flags, EFFECT_NAMES[seg.effect],
+             seg.color.r, seg.color.g, seg.color.b, seg.periodMs);
+    text += item;
+  }
+  return text;
+}
+
+uint8_t SegmentCompositor::getCount() const
+{
+  return count;
+}
+
+// 每段先在临时缓冲区按段长渲染（镜像时只渲染一半），再按方向写入目标灯带
+void SegmentCompositor::render(CRGB *main, CRGB *ring, uint32_t nowMs) const
+{
+  CRGB *strips[STRIP_COUNT] = {main, ring};
+  CRGB scratch[Config::MAIN_NUM_LEDS];
+  fill_solid(main, Config::MAIN_NUM_LEDS, CRGB::Black);
+  fill_solid(ring, Config::RING_NUM_LEDS, CRGB::Black);
+
+  for (uint8_t i = 0; i < count; i++)
+  {
+    const Segment &seg = segments[i];
+    uint8_t rendered = (seg.flags & SEG_MIRROR) ? (seg.length + 1) / 2 : seg.length;
+    RENDERERS[seg.effect](scratch, rendered, seg, nowMs);
+
+    CRGB *out = strips[seg.strip] + seg.start;
+    for (uint8_t j = 0; j < seg.length; j++)
+    {
+      uint8_t src = j < rendered ? j : seg.length - 1 - j;
+      out[(seg.flags & SEG_REVERSE) ? seg.length - 1 - j : j] = scratch[src];
+    }
+  }
+}
+
+// 主灯带均分为1/8/16段，效果轮换，测整帧合成开销；在独立实例和临时缓冲区上运行
+void SegmentCompositor::benchmark(BenchmarkSuite &suite)
+{
+  static CRGB scratchMain[Config::MAIN_NUM_LEDS];
+  static CRGB scratchRing[Config::RING_NUM_LEDS];
+  static SegmentCompositor probe;
+  Segment list[MAX_SEGMENTS];
+  uint32_t t = 0;
+
+  auto layout = [&](uint8_t n)
+  {
+    uint8_t length = Config::MAIN_NUM_LEDS / n;
+    for (uint8_t i = 0; i < n; i++)
+      list[i] = Segment{STRIP_MAIN, (uint8_t)(i * length), length, (uint8_t)((i & 1) ? SEG_REVERSE : 0),
+                        (uint8_t)(i % SEG_EFFECT_COUNT), CRGB(255, 120, 40), 3000};
+    probe.setSegments(list, n);
+  };
+
+  layout(1);
+  suite.run("segments_1", 200, [&]() { probe.render(scratchMain, scratchRing, t += 10); });
+  layout(8);
+  suite.run("segments_8", 200, [&]() { probe.render(scratchMain, scratchRing, t += 10); });
+  layout(16);
+  suite.run("segments_16", 200, [&]() { probe.render(scratchMain, scratchRing, t += 10); });
+}
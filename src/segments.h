@@ -0,0 +1,66 @@
+#ifndef SEGMENTS_H
+#define SEGMENTS_H
+
+#include <Arduino.h>
+#include <FastLED.h>
+#include "config.h"
+#include "benchmark.h"
+
+// 分段：把一条灯带切成若干区间，每段运行自己的效果和周期，由合成器一次性写入输出缓冲区
+enum SegmentStrip : uint8_t
+{
+  STRIP_MAIN,
+  STRIP_RING,
+  STRIP_COUNT
+};
+
+enum SegmentEffect : uint8_t
+{
+  SEG_SOLID,
+  SEG_RAINBOW,
+  SEG_BREATHE,
+  SEG_CHASE,
+  SEG_NATURAL,     // 跟随昼夜节律的自然光漂移
+  SEG_EFFECT_COUNT
+};
+
+enum SegmentFlags : uint8_t
+{
+  SEG_REVERSE = 1 << 0,   // 段内方向反转
+  SEG_MIRROR = 1 << 1     // 只渲染前半段，后半段镜像
+};
+
+struct Segment
+{
+  uint8_t strip;          // SegmentStrip
+  uint8_t start;
+  uint8_t length;
+  uint8_t flags;          // SegmentFlags
+  uint8_t effect;         // SegmentEffect
+  CRGB color;
+  uint16_t periodMs;      // 效果周期（彩虹转一圈、呼吸一次、追光跑一趟）
+};
+
+class SegmentCompositor
+{
+public:
+  static const uint8_t MAX_SEGMENTS = 16;
+
+  SegmentCompositor();
+  bool setSegments(const Segment *list, uint8_t count);
+  bool parse(const String &text);       // "strip,start,len,flags,effect,rrggbb,period;..."
+  String toString() const;
+  uint8_t getCount() const;
+
+  // 未被任何段覆盖的像素为黑色；段重叠时后面的段覆盖前面的
+  void render(CRGB *main, CRGB *ring, uint32_t nowMs) const;
+  void benchmark(BenchmarkSuite &suite);
+
+private:
+  Segment segments[MAX_SEGMENTS];
+  uint8_t count;
+};
+
+extern SegmentCompositor segmentCompositor;
+
+#endif
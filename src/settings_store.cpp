@@ -0,0 +1,126 @@
+#include "settings_store.h"
+#include <Preferences.h>
+
+SettingsStore settingsStore;
+
+static const char *NVS_NAMESPACE = "led";
+static const char *NVS_KEY = "settings";
+
+// 设备端：基于Preferences的NVS存储
+class PreferencesNvs : public NvsStorage
+{
+private:
+    Preferences prefs;
+
+public:
+    bool begin() override
+    {
+        return prefs.begin(NVS_NAMESPACE, false);
+    }
+
+    size_t read(const char *key, void *buf, size_t len) override
+    {
+        if (prefs.getBytesLength(key) != len)
+            return 0;
+        return prefs.getBytes(key, buf, len);
+    }
+
+    size_t write(const char *key, const void *buf, size_t len) override
+    {
+        return prefs.putBytes(key, buf, len);
+    }
+};
+
+static PreferencesNvs preferencesNvs;
+static MemoryNvs fallbackNvs;
+
+SettingsStore::SettingsStore()
+    : storage(nullptr),
+      dirty(false),
+      lastChange(0)
+{
+  memset(&persisted, 0, sizeof(persisted));
+  memset(&pending, 0, sizeof(pending));
+}
+
+void SettingsStore::begin(NvsStorage *backend)
+{
+  storage = backend ? backend : &preferencesNvs;
+  if (!storage->begin())
+  {
+    Serial.println("NVS打开失败，设置仅保存在内存中");
+    storage = &fallbackNvs;
+    storage->begin();
+  }
+
+  Record record;
+  if (storage->read(NVS_KEY, &record, sizeof(record)) == sizeof(record) &&
+      record.version == RECORD_VERSION)
+  {
+    persisted = record;
+  }
+  else
+  {
+    // 无记录或格式不兼容：使用出厂默认值，不立即写入
+    persisted.version = 0;
+    persisted.writeCount = 0;
+  }
+  pending = persisted.settings;
+}
+
+bool SettingsStore::load(LightSettings &out) const
+{
+  if (persisted.version != RECORD_VERSION)
+    return false;
+  out = persisted.settings;
+  return true;
+}
+
+void SettingsStore::markChanged(const LightSettings &settings)
+{
+  pending = settings;
+  dirty = true;
+  lastChange = millis();
+}
+
+void SettingsStore::loop()
+{
+  if (dirty && millis() - lastChange >= Config::SETTINGS_SAVE_DELAY_MS)
+  {
+    flush();
+  }
+}
+
+void SettingsStore::flush()
+{
+  dirty = false;
+  if (storage == nullptr)
+    return;
+
+  // 内容未变化（例如滑块拖回原值）则不写Flash
+  if (persisted.version == RECORD_VERSION &&
+      memcmp(&persisted.settings, &pending, sizeof(pending)) == 0)
+    return;
+
+  Record record;
+  memset(&record, 0, sizeof(record));
+  record.version = RECORD_VERSION;
+  record.settings = pending;
+  record.writeCount = persisted.writeCount + 1;
+
+  if (storage->write(NVS_KEY, &record, sizeof(record)) == sizeof(record))
+  {
+    persisted = record;
+    Serial.print("设置已保存，累计写入次数: ");
+    Serial.println(persisted.writeCount);
+  }
+  else
+  {
+    Serial.println("设置保存失败");
+  }
+}
+
+uint32_t SettingsStore::getWriteCount() const
+{
+  return persisted.writeCount;
+}
@@ -0,0 +1,54 @@
+#ifndef SETTINGS_STORE_H
+#define SETTINGS_STORE_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "nvs_storage.h"
+
+// 需要掉电保存的用户设置
+struct LightSettings
+{
+    uint8_t brightness;
+    uint8_t red;
+    uint8_t green;
+    uint8_t blue;
+    uint8_t mode;           // LightMode
+};
+
+// 设置持久化：变更先缓存，静默一段时间后且内容确实改变才写Flash
+class SettingsStore
+{
+private:
+    // Flash中的记录格式，带版本号和累计写入次数
+    struct Record
+    {
+        uint8_t version;
+        LightSettings settings;
+        uint32_t writeCount;
+    };
+
+    static const uint8_t RECORD_VERSION = 1;
+
+    NvsStorage *storage;
+    Record persisted;          // 最近一次写入Flash的内容
+    LightSettings pending;     // 等待写入的最新设置
+    bool dirty;
+    unsigned long lastChange;
+
+    void flush();
+
+public:
+    // 构造函数
+    SettingsStore();
+
+    // 公共接口
+    void begin(NvsStorage *backend = nullptr);
+    bool load(LightSettings &out) const;
+    void markChanged(const LightSettings &settings);
+    void loop();
+    uint32_t getWriteCount() const;
+};
+
+extern SettingsStore settingsStore;
+
+#endif
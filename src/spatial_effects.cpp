@@ -0,0 +1,79 @@
+#include "spatial_effects.h"
+#include "geometry.h"
+#include "circadian.h"
+
+namespace
+{
+  const uint16_t SWEEP_PERIOD_MS = 3000;
+  const uint8_t SWEEP_WIDTH = 40;         // 光带半宽（坐标单位）
+  const uint8_t RIPPLE_SPACING = 3;       // 半径每前进1，波纹相位前进3
+
+  // 呼吸光点的软边半宽：主灯带为两个灯珠间距（x坐标），灯环为两个灯珠间隔的方位
+  const uint8_t BREATHE_MAIN_SPOT = 2 * (GEOMETRY.main[1].x - GEOMETRY.main[0].x) + 1;
+  const uint8_t BREATHE_RING_SPOT = 2 * 256 / Config::RING_NUM_LEDS;
+}
+
+// 光带中心从左侧外面走到右侧外面，两端各留一个半宽，进出都是渐变的
+void renderSweep(CRGB *main, CRGB *ring, uint32_t nowMs)
+{
+  int16_t center = (int16_t)((nowMs % SWEEP_PERIOD_MS) * (256 + 2 * SWEEP_WIDTH) / SWEEP_PERIOD_MS) - SWEEP_WIDTH;
+  CRGB color = circadian.warmWhite(255);
+  renderSpatial(main, ring, [&](const PixelCoord &p) -> CRGB
+                {
+                  int16_t d = abs((int16_t)p.x - center);
+                  if (d >= SWEEP_WIDTH)
+                    return CRGB::Black;
+                  CRGB c = color;
+                  return c.nscale8_video(falloff8(d, SWEEP_WIDTH)); });
+}
+
+void renderRipple(CRGB *main, CRGB *ring, uint32_t nowMs)
+{
+  uint8_t phase = nowMs / 4;
+  uint8_t hue = nowMs / 64;
+  renderSpatial(main, ring, [&](const PixelCoord &p)
+                { return CRGB(CHSV(hue + p.radius / 2, 255, sin8(p.radius * RIPPLE_SPACING - phase))); });
+}
+
+void renderRadial(CRGB *main, CRGB *ring, uint32_t)
+{
+  CRGB inner = circadian.warmWhite(255, -300);
+  CRGB outer = circadian.warmWhite(160, 1500);
+  renderSpatial(main, ring, [&](const PixelCoord &p)
+                { return blend(inner, outer, p.radius); });
+}
+
+// 前半程亮度渐强、后半程渐弱；灯环光点从正上方顺时针转
+void renderBreathe(CRGB *main, CRGB *ring, uint16_t step)
+{
+  uint8_t mainPos = (step < Config::MAIN_NUM_LEDS) ? step : (2 * Config::MAIN_NUM_LEDS - 1 - step);
+  uint8_t brightness;
+  if (step < Config::MAIN_NUM_LEDS)
+    brightness = (uint16_t)step * 255 / Config::MAIN_NUM_LEDS;
+  else
+    brightness = (uint16_t)(Config::BREATHE_STEPS - step) * 255 / Config::MAIN_NUM_LEDS;
+
+  uint8_t spotX = GEOMETRY.main[mainPos].x;
+  uint8_t spotAngle = 64 - (uint8_t)((uint16_t)step * 256 / Config::BREATHE_STEPS);
+  for (uint8_t i = 0; i < Config::MAIN_NUM_LEDS; i++)
+  {
+    uint8_t v = scale8(brightness, falloff8(abs((int16_t)GEOMETRY.main[i].x - spotX), BREATHE_MAIN_SPOT));
+    main[i] = CRGB(v, v, v);
+  }
+  for (uint8_t i = 0; i < Config::RING_NUM_LEDS; i++)
+  {
+    uint8_t v = scale8(brightness, falloff8(angleDistance(GEOMETRY.ring[i].angle, spotAngle), BREATHE_RING_SPOT));
+    ring[i] = CRGB(v, v, v);
+  }
+}
+
+// 每项都覆盖主灯带+灯环全部像素，可与按下标渲染的效果直接比较
+void benchmarkSpatialEffects(BenchmarkSuite &suite)
+{
+  static CRGB scratchMain[Config::MAIN_NUM_LEDS];
+  static CRGB scratchRing[Config::RING_NUM_LEDS];
+  uint32_t t = 0;
+  suite.run("spatial_sweep", 200, [&]() { renderSweep(scratchMain, scratchRing, t += 10); });
+  suite.run("spatial_ripple", 200, [&]() { renderRipple(scratchMain, scratchRing, t += 10); });
+  suite.run("spatial_radial", 200, [&]() { renderRadial(scratchMain, scratchRing, t += 10); });
+}
@@ -0,0 +1,17 @@
+#ifndef SPATIAL_EFFECTS_H
+#define SPATIAL_EFFECTS_H
+
+#include <FastLED.h>
+#include "benchmark.h"
+
+// 空间效果：按几何映射中的坐标渲染，同一段代码同时覆盖主灯带和灯环
+void renderSweep(CRGB *main, CRGB *ring, uint32_t nowMs);    // 暖白光带沿x方向扫过整个灯具
+void renderRipple(CRGB *main, CRGB *ring, uint32_t nowMs);   // 以灯环圆心为中心向外扩散的彩色波纹
+void renderRadial(CRGB *main, CRGB *ring, uint32_t nowMs);   // 按到灯环圆心的距离从暖到冷的色温渐变
+
+// 呼吸模式的一步（0..BREATHE_STEPS-1）：主灯带上的光点沿x来回，灯环上的光点转一圈
+void renderBreathe(CRGB *main, CRGB *ring, uint16_t step);
+
+void benchmarkSpatialEffects(BenchmarkSuite &suite);
+
+#endif
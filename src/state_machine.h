@@ -0,0 +1,200 @@
+#ifndef STATE_MACHINE_H
+#define STATE_MACHINE_H
+
+#include <stdint.h>
+
+// 灯光阶段：原来的 STATE_X / STATE_AUTO_X 合并为同一阶段，是否自动模式由独立标志表示
+enum Phase : uint8_t
+{
+  PHASE_OFF,
+  PHASE_BREATHE,
+  PHASE_FADE_IN,
+  PHASE_NORMAL,
+  PHASE_FADE_OUT,
+  PHASE_MANUAL,
+  PHASE_STARLIGHT_WAKEUP,
+  PHASE_STARLIGHT_NORMAL,
+  PHASE_TIMELINE,
+  PHASE_STREAM,
+  PHASE_SEGMENTS,
+  PHASE_LAYERS,
+  PHASE_COUNT,
+  PHASE_NONE = 0xFF // 表中表示“忽略该事件”
+};
+
+// 阶段名称，用于性能剖析输出等诊断信息
+constexpr const char *PHASE_NAMES[PHASE_COUNT] = {
+    "off", "breathe", "fade_in", "normal", "fade_out",
+    "manual", "star_wakeup", "star_normal", "timeline", "stream", "segments", "layers"};
+
+inline const char *phaseName(uint8_t p)
+{
+  return p < PHASE_COUNT ? PHASE_NAMES[p] : "?";
+}
+
+enum Event : uint8_t
+{
+  EV_DONE,          // 当前阶段的动画完成
+  EV_MOTION_ON,     // 检测到人体（仅自动模式响应）
+  EV_MOTION_OFF,    // 人离开（仅自动模式响应）
+  EV_MODE_OFF,
+  EV_MODE_BREATHE,
+  EV_MODE_RAINBOW,
+  EV_MODE_MANUAL,
+  EV_MODE_STARLIGHT,
+  EV_MODE_TIMELINE,
+  EV_MODE_SEGMENTS,
+  EV_MODE_LAYERS,
+  EV_STREAM_START,  // 收到像素流，接管灯带
+  EV_STOP,          // 中止当前内容并淡出（例如时间轴被重新上传）
+  EV_COUNT
+};
+
+// 转移表：按 [是否自动][阶段][事件] 直接索引
+struct TransitionTable
+{
+  Phase next[2][PHASE_COUNT][EV_COUNT];
+};
+
+// 有限时长的阶段必须有EV_DONE出口，其余阶段不应有
+constexpr bool PHASE_FINITE[PHASE_COUNT] = {
+    false, // OFF
+    true,  // BREATHE
+    true,  // FADE_IN
+    false, // NORMAL
+    true,  // FADE_OUT
+    false, // MANUAL
+    true,  // STARLIGHT_WAKEUP
+    false, // STARLIGHT_NORMAL
+    true,  // TIMELINE（非循环时间轴结束）
+    false, // STREAM（超时由控制器按原模式恢复）
+    false, // SEGMENTS
+    false  // LAYERS
+};
+
+// 用户选择具体模式或外部接管时退出自动模式
+constexpr bool EVENT_CLEARS_AUTO[EV_COUNT] = {
+    false, false, false,                    // DONE, MOTION_ON, MOTION_OFF
+    true, true, true, true, true, true, true, true, // MODE_*
+    true,                                   // STREAM_START
+    false                                   // STOP
+};
+
+constexpr TransitionTable buildTransitions()
+{
+  TransitionTable t{};
+  for (int a = 0; a < 2; a++)
+    for (int p = 0; p < PHASE_COUNT; p++)
+      for (int e = 0; e < EV_COUNT; e++)
+        t.next[a][p][e] = PHASE_NONE;
+
+  for (int a = 0; a < 2; a++)
+  {
+    for (int p = 0; p < PHASE_COUNT; p++)
+    {
+      // 用户选择模式：任何阶段都可进入
+      t.next[a][p][EV_MODE_OFF] = PHASE_FADE_OUT;
+      t.next[a][p][EV_MODE_BREATHE] = PHASE_BREATHE;
+      t.next[a][p][EV_MODE_RAINBOW] = PHASE_FADE_IN;
+      t.next[a][p][EV_MODE_MANUAL] = PHASE_MANUAL;
+      t.next[a][p][EV_MODE_STARLIGHT] = PHASE_STARLIGHT_WAKEUP;
+      t.next[a][p][EV_MODE_TIMELINE] = PHASE_TIMELINE;
+      t.next[a][p][EV_MODE_SEGMENTS] = PHASE_SEGMENTS;
+      t.next[a][p][EV_MODE_LAYERS] = PHASE_LAYERS;
+      if (p != PHASE_STREAM)
+        t.next[a][p][EV_STREAM_START] = PHASE_STREAM;
+
+      // 人体感应只在自动模式下起作用
+      if (a == 1)
+      {
+        t.next[a][p][EV_MOTION_ON] = PHASE_BREATHE;
+        t.next[a][p][EV_MOTION_OFF] = PHASE_FADE_OUT;
+      }
+    }
+
+    // 动画完成后的后继阶段
+    t.next[a][PHASE_BREATHE][EV_DONE] = a ? PHASE_FADE_IN : PHASE_BREATHE; // 手动呼吸循环，自动呼吸后淡入彩虹
+    t.next[a][PHASE_FADE_IN][EV_DONE] = PHASE_NORMAL;
+    t.next[a][PHASE_FADE_OUT][EV_DONE] = PHASE_OFF;
+    t.next[a][PHASE_STARLIGHT_WAKEUP][EV_DONE] = PHASE_STARLIGHT_NORMAL;
+    t.next[a][PHASE_TIMELINE][EV_DONE] = PHASE_FADE_OUT;
+    t.next[a][PHASE_TIMELINE][EV_STOP] = PHASE_FADE_OUT;
+  }
+  return t;
+}
+
+constexpr TransitionTable TRANSITIONS = buildTransitions();
+
+// ---- 编译期校验 ----
+
+// 所有目标阶段合法
+constexpr bool transitionsValid(const TransitionTable &t)
+{
+  for (int a = 0; a < 2; a++)
+    for (int p = 0; p < PHASE_COUNT; p++)
+      for (int e = 0; e < EV_COUNT; e++)
+        if (t.next[a][p][e] != PHASE_NONE && t.next[a][p][e] >= PHASE_COUNT)
+          return false;
+  return true;
+}
+
+// 从初始阶段出发（自动标志可由用户切换），所有阶段都可达
+constexpr bool allPhasesReachable(const TransitionTable &t, Phase initial)
+{
+  bool reached[PHASE_COUNT] = {};
+  reached[initial] = true;
+  bool changed = true;
+  while (changed)
+  {
+    changed = false;
+    for (int a = 0; a < 2; a++)
+      for (int p = 0; p < PHASE_COUNT; p++)
+        if (reached[p])
+          for (int e = 0; e < EV_COUNT; e++)
+          {
+            Phase n = t.next[a][p][e];
+            if (n != PHASE_NONE && !reached[n])
+            {
+              reached[n] = true;
+              changed = true;
+            }
+          }
+  }
+  for (int p = 0; p < PHASE_COUNT; p++)
+    if (!reached[p])
+      return false;
+  return true;
+}
+
+// 有限阶段必有EV_DONE出口（否则会卡死），无限阶段不应有（死转移）
+constexpr bool doneEdgesConsistent(const TransitionTable &t)
+{
+  for (int a = 0; a < 2; a++)
+    for (int p = 0; p < PHASE_COUNT; p++)
+      if ((t.next[a][p][EV_DONE] != PHASE_NONE) != PHASE_FINITE[p])
+        return false;
+  return true;
+}
+
+// 每个阶段都存在离开自身的转移
+constexpr bool noTrapPhases(const TransitionTable &t)
+{
+  for (int a = 0; a < 2; a++)
+    for (int p = 0; p < PHASE_COUNT; p++)
+    {
+      bool canLeave = false;
+      for (int e = 0; e < EV_COUNT; e++)
+        if (t.next[a][p][e] != PHASE_NONE && t.next[a][p][e] != p)
+          canLeave = true;
+      if (!canLeave)
+        return false;
+    }
+  return true;
+}
+
+static_assert(transitionsValid(TRANSITIONS), "转移表包含非法阶段");
+static_assert(allPhasesReachable(TRANSITIONS, PHASE_OFF), "存在不可达阶段");
+static_assert(doneEdgesConsistent(TRANSITIONS), "EV_DONE出口与PHASE_FINITE不一致");
+static_assert(noTrapPhases(TRANSITIONS), "存在无法离开的阶段");
+
+#endif
@@ -0,0 +1,241 @@
+#include "stress_test.h"
+#include <WiFi.h>
+#include <algorithm>
+#include "command_queue.h"
+#include "motion_sensor.h"
+#include "LED_Controller.h"
+
+StressTest stressTest;
+
+// 依次测试的模式；自动模式段内人体传感器电平反复翻转，覆盖淡入、常亮、淡出和熄灭
+const LightMode StressTest::STEPS[STEP_COUNT] = {
+    MODE_BREATHE, MODE_RAINBOW, MODE_STARLIGHT, MODE_SEGMENTS, MODE_LAYERS, MODE_AUTO};
+
+StressTest::StressTest()
+    : running(false),
+      finished(false),
+      pirLevel(false),
+      clients(0),
+      step(0),
+      secondsPerEffect(0),
+      budgetUs(Config::STRESS_JITTER_BUDGET_US),
+      startMs(0),
+      lastPirToggle(0),
+      pirEdges(0),
+      lastShowUs(0),
+      lastPhase(PHASE_COUNT),
+      requests(0),
+      failures(0),
+      activeClients(0)
+{
+  memset(results, 0, sizeof(results));
+}
+
+bool StressTest::isRunning() const
+{
+  return running;
+}
+
+// 上一轮的客户端任务还没退出时拒绝启动
+bool StressTest::start(uint8_t clientCount, uint16_t seconds, uint32_t budget)
+{
+  if (running || activeClients.load() > 0 || clientCount == 0 || clientCount > Config::STRESS_MAX_CLIENTS ||
+      seconds == 0 || seconds > Config::STRESS_MAX_SECONDS)
+    return false;
+
+  saved = ledController.currentSettings();
+  memset(results, 0, sizeof(results));
+  requests = 0;
+  failures = 0;
+  pirEdges = 0;
+  pirLevel = false;
+  lastShowUs = 0;
+  lastPhase = PHASE_COUNT;
+  clients = clientCount;
+  secondsPerEffect = seconds;
+  budgetUs = budget;
+  step = STEP_COUNT;
+  startMs = millis();
+  lastPirToggle = startMs;
+  finished = false;
+  running = true;
+
+  for (uint8_t i = 0; i < clientCount; i++)
+  {
+    activeClients++;
+    if (xTaskCreatePinnedToCore(clientTask, "stress", 4096, this, 1, nullptr, 0) != pdPASS)
+      activeClients--;
+  }
+  return true;
+}
+
+void StressTest::clientTask(void *arg)
+{
+  StressTest *self = static_cast<StressTest *>(arg);
+  self->runClient();
+  self->activeClients--;
+  vTaskDelete(nullptr);
+}
+
+// 轮流发送亮度、颜色和首页请求，读完应答再发下一个；连接失败或超时计入失败数
+void StressTest::runClient()
+{
+  char request[96];
+  uint8_t buffer[256];
+  uint32_t n = random(3);
+  while (running)
+  {
+    switch (n++ % 3)
+    {
+    case 0:
+      snprintf(request, sizeof(request), "GET /control?brightness=%ld HTTP/1.1\r\nHost: stress\r\nConnection: close\r\n\r\n",
+               random(20, 101));
+      break;
+    case 1:
+      snprintf(request, sizeof(request), "GET /control?r=%ld&g=%ld&b=%ld HTTP/1.1\r\nHost: stress\r\nConnection: close\r\n\r\n",
+               random(256), random(256), random(256));
+      break;
+    default:
+      snprintf(request, sizeof(request), "GET / HTTP/1.1\r\nHost: stress\r\nConnection: close\r\n\r\n");
+      break;
+    }
+
+    WiFiClient client;
+    bool ok = false;
+    if (client.connect(WiFi.localIP(), Config::serverPort(), 1000))
+    {
+      client.print(request);
+      unsigned long start = millis();
+      while (millis() - start < 2000)
+      {
+        int got = client.read(buffer, sizeof(buffer));
+        if (got > 0)
+          ok = true;
+        else if (!client.connected())
+          break;
+        else
+          vTaskDelay(1);
+      }
+    }
+    client.stop();
+    requests++;
+    if (!ok)
+      failures++;
+  }
+}
+
+void StressTest::loop(uint32_t nowMs)
+{
+  if (!running)
+    return;
+
+  uint8_t current = (nowMs - startMs) / (secondsPerEffect * 1000UL);
+  if (current >= STEP_COUNT)
+  {
+    finish();
+    return;
+  }
+  // 切换模式走与网页相同的命令队列
+  if (current != step)
+  {
+    step = current;
+    lastPhase = PHASE_COUNT;
+    commandQueue.push(Command{CMD_SET_MODE, (uint8_t)STEPS[step], 0, 0});
+  }
+  if (STEPS[step] == MODE_AUTO && nowMs - lastPirToggle >= Config::STRESS_PIR_TOGGLE_MS)
+  {
+    lastPirToggle = nowMs;
+    pirLevel = !pirLevel;
+    motionsensor.simulate(pirLevel);
+    pirEdges++;
+  }
+}
+
+// 同一阶段内相邻两次刷新的间隔；阶段切换后的第一帧不计
+void StressTest::noteFrame(Phase phase, uint16_t targetFps)
+{
+  if (!running)
+    return;
+  uint32_t now = micros();
+  if (phase == lastPhase && lastShowUs != 0 && targetFps != 0)
+  {
+    uint32_t interval = now - lastShowUs;
+    uint16_t sample = interval > 0xFFFF ? 0xFFFF : interval;
+    EffectResult &r = results[phase];
+    r.targetUs = 1000000UL / targetFps;
+    if (r.frames < MAX_SAMPLES)
+      samples[phase][r.frames] = sample;
+    else
+    {
+      uint32_t j = random(r.frames + 1);
+      if (j < MAX_SAMPLES)
+        samples[phase][j] = sample;
+    }
+    r.frames++;
+    if (interval > r.maxUs)
+      r.maxUs = interval;
+  }
+  lastPhase = phase;
+  lastShowUs = now;
+}
+
+// 停止客户端、恢复真实传感器和测试前的设置，再排序采样算分位数
+void StressTest::finish()
+{
+  running = false;
+  finished = true;
+  motionsensor.simulate(-1);
+  brightnessSlot.post(saved.brightness);
+  colorSlot.post(((uint32_t)saved.red << 16) | (saved.green << 8) | saved.blue);
+  commandQueue.push(Command{CMD_SET_MODE, saved.mode, 0, 0});
+
+  for (uint8_t p = 0; p < PHASE_COUNT; p++)
+  {
+    EffectResult &r = results[p];
+    uint16_t n = r.frames < MAX_SAMPLES ? r.frames : MAX_SAMPLES;
+    if (n == 0)
+      continue;
+    std::sort(samples[p], samples[p] + n);
+    r.p50Us = samples[p][n / 2];
+    r.p99Us = samples[p][(n * 99) / 100];
+  }
+}
+
+bool StressTest::passed(uint8_t phase) const
+{
+  const EffectResult &r = results[phase];
+  return r.p99Us <= r.targetUs + budgetUs;
+}
+
+size_t StressTest::render(char *out, size_t cap) const
+{
+  uint32_t elapsed = running ? (millis() - startMs) / 1000 : 0;
+  int used = snprintf(out, cap,
+                      "{\"state\":\"%s\",\"clients\":%u,\"secondsPerEffect\":%u,\"elapsedS\":%lu,"
+                      "\"requests\":%lu,\"failures\":%lu,\"pirEdges\":%lu,\"budgetUs\":%lu",
+                      running ? "running" : finished ? "done" : "idle", clients, secondsPerEffect,
+                      (unsigned long)elapsed, (unsigned long)requests.load(), (unsigned long)failures.load(),
+                      (unsigned long)pirEdges, (unsigned long)budgetUs);
+  if (finished && !running)
+  {
+    bool pass = true;
+    used += snprintf(out + used, used < (int)cap ? cap - used : 0, ",\"effects\":[");
+    bool first = true;
+    for (uint8_t p = 0; p < PHASE_COUNT && used < (int)cap; p++)
+    {
+      const EffectResult &r = results[p];
+      if (r.frames == 0)
+        continue;
+      pass &= passed(p);
+      used += snprintf(out + used, cap - used,
+                       "%s{\"phase\":\"%s\",\"frames\":%lu,\"targetUs\":%lu,\"p50Us\":%lu,\"p99Us\":%lu,\"maxUs\":%lu,\"pass\":%s}",
+                       first ? "" : ",", phaseName(p), (unsigned long)r.frames, (unsigned long)r.targetUs,
+                       (unsigned long)r.p50Us, (unsigned long)r.p99Us, (unsigned long)r.maxUs,
+                       passed(p) ? "true" : "false");
+      first = false;
+    }
+    used += snprintf(out + used, used < (int)cap ? cap - used : 0, "],\"pass\":%s", pass ? "true" : "false");
+  }
+  used += snprintf(out + used, used < (int)cap ? cap - used : 0, "}");
+  return used < (int)cap ? used : cap - 1;
+}
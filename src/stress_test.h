@@ -0,0 +1,67 @@
+#ifndef STRESS_TEST_H
+#define STRESS_TEST_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "config.h"
+#include "state_machine.h"
+#include "settings_store.h"
+
+/*
+帧抖动压力测试：N个模拟客户端在核心0上经本机回环不停请求 /control 和 /，
+走真实的WebServer处理函数；主循环依次切换各效果，自动模式段内按固定间隔翻转模拟的人体传感器电平。
+每次刷新灯带时按当前阶段记录帧间隔，结束后给出每个效果的p50/p99/max，
+p99超出目标帧周期的部分大于预算即判为失败。测试前的亮度、颜色和模式在结束时恢复。
+*/
+class StressTest
+{
+public:
+  struct EffectResult
+  {
+    uint32_t frames;
+    uint32_t targetUs;      // 1e6 / 该阶段目标帧率
+    uint32_t p50Us;
+    uint32_t p99Us;
+    uint32_t maxUs;
+  };
+
+  StressTest();
+  bool start(uint8_t clients, uint16_t secondsPerEffect, uint32_t budgetUs);
+  void loop(uint32_t nowMs);
+  bool isRunning() const;
+  void noteFrame(Phase phase, uint16_t targetFps);  // 由控制器在每次刷新灯带时调用，静态阶段fps为0
+  size_t render(char *out, size_t cap) const;       // 进度或结果JSON
+
+private:
+  static const uint16_t MAX_SAMPLES = 256;          // 每个阶段的蓄水池采样数
+  static const uint8_t STEP_COUNT = 6;
+  static const LightMode STEPS[STEP_COUNT];
+
+  volatile bool running;
+  bool finished;
+  bool pirLevel;
+  uint8_t clients;
+  uint8_t step;
+  uint16_t secondsPerEffect;
+  uint32_t budgetUs;
+  uint32_t startMs;
+  uint32_t lastPirToggle;
+  uint32_t pirEdges;
+  uint32_t lastShowUs;
+  uint8_t lastPhase;
+  LightSettings saved;
+  std::atomic<uint32_t> requests;
+  std::atomic<uint32_t> failures;
+  std::atomic<uint8_t> activeClients;
+  uint16_t samples[PHASE_COUNT][MAX_SAMPLES];
+  EffectResult results[PHASE_COUNT];
+
+  static void clientTask(void *arg);
+  void runClient();
+  void finish();
+  bool passed(uint8_t phase) const;
+};
+
+extern StressTest stressTest;
+
+#endif
@@ -0,0 +1,25 @@
+#include "text_util.h"
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+
+size_t appendf(char *out, size_t cap, size_t used, const char *fmt, ...)
+{
+  if (used >= cap)
+    return used;
+  va_list args;
+  va_start(args, fmt);
+  int n = vsnprintf(out + used, cap - used, fmt, args);
+  va_end(args);
+  if (n < 0)
+    return used;
+  return used + n < cap ? used + n : cap - 1;
+}
+
+int8_t findName(const char *const *names, uint8_t count, const char *name)
+{
+  for (uint8_t i = 0; i < count; i++)
+    if (strcmp(names[i], name) == 0)
+      return i;
+  return -1;
+}
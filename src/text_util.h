@@ -0,0 +1,15 @@
+#ifndef TEXT_UTIL_H
+#define TEXT_UTIL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// 文本输出的公用小工具，不依赖Arduino头文件，主机端也能编译
+
+// 追加格式化输出，缓冲区不足时截断但不越界；返回新的已用长度
+size_t appendf(char *out, size_t cap, size_t used, const char *fmt, ...);
+
+// 在名称表中查找name，返回下标，找不到返回-1
+int8_t findName(const char *const *names, uint8_t count, const char *name);
+
+#endif
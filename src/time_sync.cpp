@@ -0,0 +1,250 @@
+#include "time_sync.h"
+#include "wifi_manager.h"
+#include <esp_timer.h>
+
+TimeSync timeSync;
+
+static const char SYNC_MAGIC[4] = {'L', 'T', 'S', '1'};
+static const unsigned long ANNOUNCE_INTERVAL_MS = 1000;
+static const unsigned long PEER_TIMEOUT_MS = 3500;
+static const int64_t MAX_RTT_US = 20000;           // 往返过慢的样本不可信
+static const int64_t STEP_THRESHOLD_US = 50000;    // 偏差过大直接跳变，否则平滑收敛
+static const float MAX_DRIFT = 500e-6f;            // 晶振漂移上限 ±500ppm
+
+TimeSync::TimeSync()
+    : listening(false),
+      nodeId(0),
+      peerCount(0),
+      isLeader(true),
+      synced(false),
+      offsetUs(0),
+      anchorUs(0),
+      drift(0),
+      pendingT1(0),
+      lastRttUs(0),
+      lastAnnounce(0),
+      virtualActive(false),
+      virtualMs(0)
+{
+}
+
+void TimeSync::begin()
+{
+  // getEfuseMac()低字节在前，字节0-2为厂商OUI，同批板子相同，字节3-5才是设备唯一的部分；
+  // 取字节2-5作为节点号，低24位即设备唯一的3个字节，最高字节为OUI末字节
+  nodeId = (uint32_t)(ESP.getEfuseMac() >> 16);
+}
+
+int64_t TimeSync::offsetAt(int64_t localUs) const
+{
+  return offsetUs + (int64_t)(drift * (float)(localUs - anchorUs));
+}
+
+uint32_t TimeSync::now() const
+{
+  if (virtualActive)
+    return virtualMs;
+  int64_t local = esp_timer_get_time();
+  return (uint32_t)((local + offsetAt(local)) / 1000);
+}
+
+void TimeSync::setVirtualTime(uint32_t ms)
+{
+  virtualMs = ms;
+  virtualActive = true;
+}
+
+void TimeSync::clearVirtualTime()
+{
+  virtualActive = false;
+}
+
+void TimeSync::fillHeader(Packet &packet, PacketType type) const
+{
+  memset(&packet, 0, sizeof(packet));
+  memcpy(packet.magic, SYNC_MAGIC, sizeof(SYNC_MAGIC));
+  packet.type = type;
+  packet.nodeId = nodeId;
+}
+
+void TimeSync::send(const Packet &packet, IPAddress ip)
+{
+  udp.beginPacket(ip, Config::TIME_SYNC_PORT);
+  udp.write((const uint8_t *)&packet, sizeof(packet));
+  udp.endPacket();
+}
+
+void TimeSync::notePeer(uint32_t id, IPAddress ip)
+{
+  for (uint8_t i = 0; i < peerCount; i++)
+  {
+    if (peers[i].nodeId == id)
+    {
+      peers[i].ip = ip;
+      peers[i].lastSeen = millis();
+      return;
+    }
+  }
+  if (peerCount < MAX_PEERS)
+  {
+    peers[peerCount].nodeId = id;
+    peers[peerCount].ip = ip;
+    peers[peerCount].lastSeen = millis();
+    peerCount++;
+  }
+}
+
+const TimeSync::Peer *TimeSync::findLeaderPeer() const
+{
+  const Peer *best = nullptr;
+  for (uint8_t i = 0; i < peerCount; i++)
+  {
+    if (peers[i].nodeId < nodeId && (best == nullptr || peers[i].nodeId < best->nodeId))
+      best = &peers[i];
+  }
+  return best;
+}
+
+// 清理超时节点，节点号最小者当选主节点
+void TimeSync::electLeader()
+{
+  unsigned long nowMs = millis();
+  for (uint8_t i = 0; i < peerCount;)
+  {
+    if (nowMs - peers[i].lastSeen > PEER_TIMEOUT_MS)
+      peers[i] = peers[--peerCount];
+    else
+      i++;
+  }
+
+  bool wasLeader = isLeader;
+  isLeader = (findLeaderPeer() == nullptr);
+  if (isLeader && !wasLeader)
+  {
+    // 接任主节点：冻结当前效果时钟，保证动画不跳变
+    int64_t local = esp_timer_get_time();
+    offsetUs = offsetAt(local);
+    anchorUs = local;
+    drift = 0;
+    Serial.println("时间同步: 本机成为主节点");
+  }
+}
+
+void TimeSync::applySample(int64_t t1, int64_t t2, int64_t t3, int64_t t4)
+{
+  int64_t rtt = (t4 - t1) - (t3 - t2);
+  if (rtt < 0 || rtt > MAX_RTT_US)
+    return;
+  lastRttUs = (uint32_t)rtt;
+
+  int64_t sample = ((t2 - t1) + (t3 - t4)) / 2;
+  int64_t predicted = offsetAt(t4);
+  int64_t error = sample - predicted;
+
+  if (!synced || error > STEP_THRESHOLD_US || error < -STEP_THRESHOLD_US)
+  {
+    offsetUs = sample;
+    drift = 0;
+    synced = true;
+  }
+  else
+  {
+    // 误差按时间折算成漂移率，偏移只修正四分之一，避免动画抖动
+    int64_t dt = t4 - anchorUs;
+    if (dt > 0)
+      drift = constrain(drift + 0.25f * (float)error / (float)dt, -MAX_DRIFT, MAX_DRIFT);
+    offsetUs = predicted + error / 4;
+  }
+  anchorUs = t4;
+}
+
+void TimeSync::handlePacket(const Packet &packet, int64_t receivedUs)
+{
+  if (memcmp(packet.magic, SYNC_MAGIC, sizeof(SYNC_MAGIC)) != 0 || packet.nodeId == nodeId)
+    return;
+
+  notePeer(packet.nodeId, udp.remoteIP());
+
+  switch (packet.type)
+  {
+  case PKT_REQUEST:
+    if (isLeader)
+    {
+      Packet reply;
+      fillHeader(reply, PKT_RESPONSE);
+      reply.t1 = packet.t1;
+      reply.t2 = receivedUs + offsetAt(receivedUs);
+      int64_t local = esp_timer_get_time();
+      reply.t3 = local + offsetAt(local);
+      send(reply, udp.remoteIP());
+    }
+    break;
+
+  case PKT_RESPONSE:
+    if (!isLeader && packet.t1 == pendingT1)
+    {
+      applySample(packet.t1, packet.t2, packet.t3, receivedUs);
+      pendingT1 = 0;
+    }
+    break;
+
+  default:
+    break;
+  }
+}
+
+void TimeSync::loop()
+{
+  if (!wifiManager.isConnected())
+    return;
+  if (!listening)
+  {
+    listening = udp.begin(Config::TIME_SYNC_PORT);
+    if (!listening)
+      return;
+  }
+
+  Packet packet;
+  int size;
+  while ((size = udp.parsePacket()) > 0)
+  {
+    int64_t receivedUs = esp_timer_get_time();
+    if (size == sizeof(Packet) && udp.read((uint8_t *)&packet, sizeof(packet)) == sizeof(packet))
+      handlePacket(packet, receivedUs);
+    udp.flush();
+  }
+
+  unsigned long nowMs = millis();
+  if (nowMs - lastAnnounce >= ANNOUNCE_INTERVAL_MS)
+  {
+    lastAnnounce = nowMs;
+    electLeader();
+
+    fillHeader(packet, PKT_ANNOUNCE);
+    send(packet, WiFi.broadcastIP());
+
+    const Peer *leader = findLeaderPeer();
+    if (leader != nullptr)
+    {
+      fillHeader(packet, PKT_REQUEST);
+      packet.t1 = esp_timer_get_time();
+      pendingT1 = packet.t1;
+      send(packet, leader->ip);
+    }
+  }
+}
+
+TimeSync::Status TimeSync::getStatus() const
+{
+  Status status;
+  const Peer *leader = findLeaderPeer();
+  status.nodeId = nodeId;
+  status.leaderId = leader ? leader->nodeId : nodeId;
+  status.leader = isLeader;
+  status.synced = isLeader || synced;
+  status.offsetMs = (int32_t)(offsetAt(esp_timer_get_time()) / 1000);
+  status.driftPpm = drift * 1e6f;
+  status.lastRttUs = lastRttUs;
+  status.peers = peerCount;
+  return status;
+}
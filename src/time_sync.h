@@ -0,0 +1,90 @@
+#ifndef TIME_SYNC_H
+#define TIME_SYNC_H
+
+#include <Arduino.h>
+#include <WiFiUdp.h>
+#include "config.h"
+
+// 多控制器时间同步：节点号最小者为主节点，其余节点估计与主节点的偏移和漂移
+// now() 是所有动画使用的效果时钟（毫秒），同步后各设备相位一致
+class TimeSync
+{
+public:
+    struct Status
+    {
+        uint32_t nodeId;
+        uint32_t leaderId;
+        bool leader;
+        bool synced;
+        int32_t offsetMs;        // 效果时钟相对本地时钟的偏移
+        float driftPpm;
+        uint32_t lastRttUs;
+        uint8_t peers;
+    };
+
+    TimeSync();
+    void begin();
+    void loop();
+    uint32_t now() const;        // 效果时钟（毫秒）
+    void setVirtualTime(uint32_t ms);  // 离线渲染期间now()返回虚拟时间
+    void clearVirtualTime();
+    Status getStatus() const;
+
+private:
+    static const uint8_t MAX_PEERS = 8;
+
+    enum PacketType : uint8_t
+    {
+        PKT_ANNOUNCE = 1,
+        PKT_REQUEST = 2,
+        PKT_RESPONSE = 3
+    };
+
+    struct Packet
+    {
+        char magic[4];
+        uint8_t type;
+        uint8_t reserved[3];
+        uint32_t nodeId;
+        uint32_t reserved2;
+        int64_t t1;              // 从节点发出请求的本地时间(us)
+        int64_t t2;              // 主节点收到请求时的效果时间(us)
+        int64_t t3;              // 主节点发出应答时的效果时间(us)
+    };
+
+    struct Peer
+    {
+        uint32_t nodeId;
+        IPAddress ip;
+        unsigned long lastSeen;
+    };
+
+    WiFiUDP udp;
+    bool listening;
+    uint32_t nodeId;
+    Peer peers[MAX_PEERS];
+    uint8_t peerCount;
+    bool isLeader;
+    bool synced;
+    int64_t offsetUs;            // 锚点处的偏移
+    int64_t anchorUs;            // 偏移估计的本地时间锚点
+    float drift;                 // 相对漂移率（无量纲）
+    int64_t pendingT1;
+    uint32_t lastRttUs;
+    unsigned long lastAnnounce;
+    bool virtualActive;
+    uint32_t virtualMs;
+
+    int64_t offsetAt(int64_t localUs) const;
+    void electLeader();
+    const Peer *findLeaderPeer() const;
+    void notePeer(uint32_t id, IPAddress ip);
+    void handlePacket(const Packet &packet, int64_t receivedUs);
+    void applySample(int64_t t1, int64_t t2, int64_t t3, int64_t t4);
+    void send(const Packet &packet, IPAddress ip);
+    void fillHeader(Packet &packet, PacketType type) const;
+};
+
+extern TimeSync timeSync;
+
+#endif
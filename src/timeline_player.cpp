@@ -0,0 +1,335 @@
+#include "timeline_player.h"
+#include <LittleFS.h>
+#include "easing.h"
+
+TimelinePlayer timelinePlayer;
+
+static const char *TIMELINE_PATH = "/timeline.lkt";
+static const char *UPLOAD_PATH = "/timeline.tmp";
+static const uint8_t HEADER_SIZE = 28;
+
+static uint32_t readU32(const uint8_t *p)
+{
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t readU16(const uint8_t *p)
+{
+  return (uint16_t)p[0] | ((uint16_t)p[1] << 8);
+}
+
+TimelinePlayer::TimelinePlayer()
+    : mainLeds(nullptr),
+      ringLeds(nullptr),
+      mounted(false),
+      playing(false),
+      looping(false),
+      durationMs(0),
+      startMs(0),
+      uploadOk(false)
+{
+  memset(&stats, 0, sizeof(stats));
+}
+
+void TimelinePlayer::begin(CRGB *main, CRGB *ring)
+{
+  mainLeds = main;
+  ringLeds = ring;
+}
+
+// 文件系统延迟到第一次使用时挂载，避免拖慢开机首帧
+bool TimelinePlayer::mount()
+{
+  if (!mounted)
+  {
+    mounted = LittleFS.begin(true);
+    if (!mounted)
+      Serial.println("LittleFS挂载失败");
+  }
+  return mounted;
+}
+
+bool TimelinePlayer::hasTimeline()
+{
+  return mount() && LittleFS.exists(TIMELINE_PATH);
+}
+
+bool TimelinePlayer::start()
+{
+  stop();
+  if (!mount() || !openTracks())
+  {
+    Serial.println("时间轴文件无效或不存在");
+    return false;
+  }
+  memset(&stats, 0, sizeof(stats));
+  startMs = millis();
+  playing = true;
+  return true;
+}
+
+void TimelinePlayer::stop()
+{
+  for (uint8_t i = 0; i < TRACK_COUNT; i++)
+  {
+    if (tracks[i].file)
+      tracks[i].file.close();
+  }
+  playing = false;
+}
+
+bool TimelinePlayer::isPlaying() const
+{
+  return playing;
+}
+
+const TimelinePlayer::Stats &TimelinePlayer::getStats() const
+{
+  return stats;
+}
+
+bool TimelinePlayer::openTracks()
+{
+  File header = LittleFS.open(TIMELINE_PATH, "r");
+  if (!header)
+    return false;
+
+  uint8_t raw[HEADER_SIZE];
+  size_t fileSize = header.size();
+  bool valid = header.read(raw, HEADER_SIZE) == HEADER_SIZE &&
+               memcmp(raw, "LKT1", 4) == 0 && raw[4] == 1;
+  header.close();
+  if (!valid)
+    return false;
+
+  looping = raw[5] & 0x01;
+  durationMs = readU32(raw + 8);
+
+  for (uint8_t i = 0; i < TRACK_COUNT; i++)
+  {
+    Track &track = tracks[i];
+    track.offset = readU32(raw + 12 + i * 8);
+    track.keyCount = readU16(raw + 16 + i * 8);
+    if (track.offset < HEADER_SIZE || track.offset > fileSize)
+      return false;
+
+    // 每条轨道独立句柄，按顺序读取，互不回退
+    track.file = LittleFS.open(TIMELINE_PATH, "r");
+    if (!track.file)
+      return false;
+    rewindTrack(track);
+  }
+  return true;
+}
+
+void TimelinePlayer::rewindTrack(Track &track)
+{
+  track.file.seek(track.offset);
+  track.keysRead = 0;
+  track.head = 0;
+  track.used = 0;
+  track.hasPrev = false;
+  track.hasNext = false;
+}
+
+// 缓冲区空出一整块时才读文件，减少小块读取次数
+void TimelinePlayer::refill(Track &track)
+{
+  while (BUFFER_SIZE - track.used >= REFILL_CHUNK && track.file.available())
+  {
+    uint16_t tail = (track.head + track.used) % BUFFER_SIZE;
+    uint16_t span = BUFFER_SIZE - tail;
+    if (span > REFILL_CHUNK)
+      span = REFILL_CHUNK;
+    int n = track.file.read(track.buffer + tail, span);
+    if (n <= 0)
+      break;
+    track.used += n;
+  }
+  if (track.used > stats.bufferPeak)
+    stats.bufferPeak = track.used;
+}
+
+bool TimelinePlayer::readBytes(Track &track, uint8_t *out, uint16_t len)
+{
+  if (track.used < len)
+  {
+    refill(track);
+    if (track.used < len)
+      return false;
+  }
+  for (uint16_t i = 0; i < len; i++)
+  {
+    out[i] = track.buffer[track.head];
+    track.head = (track.head + 1) % BUFFER_SIZE;
+  }
+  track.used -= len;
+  return true;
+}
+
+bool TimelinePlayer::decodeKey(Track &track, Key &key)
+{
+  if (track.keysRead >= track.keyCount)
+    return false;
+
+  uint8_t raw[6];
+  if (!readBytes(track, raw, sizeof(raw)))
+    return false;
+
+  key.timeMs = readU32(raw);
+  key.easing = raw[4] < EASE_COUNT ? raw[4] : EASE_LINEAR;
+  key.stopCount = raw[5];
+  if (key.stopCount == 0 || key.stopCount > MAX_STOPS)
+    return false;
+  if (!readBytes(track, (uint8_t *)key.stops, key.stopCount * sizeof(Stop)))
+    return false;
+
+  track.keysRead++;
+  return true;
+}
+
+// 推进到包含时间t的关键帧区间
+void TimelinePlayer::advance(Track &track, uint32_t t)
+{
+  if (!track.hasPrev)
+  {
+    track.hasPrev = decodeKey(track, track.prev);
+    track.hasNext = track.hasPrev && decodeKey(track, track.next);
+  }
+  while (track.hasNext && t >= track.next.timeMs)
+  {
+    track.prev = track.next;
+    track.hasNext = decodeKey(track, track.next);
+  }
+}
+
+// 文件中的缓动编号 -> 缓动曲线库
+static const EasingCurve TIMELINE_CURVES[EASE_COUNT] = {
+    CURVE_LINEAR, CURVE_IN_QUAD, CURVE_OUT_QUAD, CURVE_IN_OUT_QUAD,
+    CURVE_LINEAR, CURVE_SINE, CURVE_EXPO, CURVE_CIE};
+
+uint8_t TimelinePlayer::ease(uint8_t easing, uint8_t progress)
+{
+  if (easing == EASE_STEP)
+    return 0;
+  return ease8(TIMELINE_CURVES[easing < EASE_COUNT ? easing : EASE_LINEAR], progress);
+}
+
+// 在关键帧的色标之间按位置插值
+CRGB TimelinePlayer::sampleKey(const Key &key, uint8_t pos)
+{
+  const Stop *stops = key.stops;
+  if (pos <= stops[0].pos || key.stopCount == 1)
+    return CRGB(stops[0].r, stops[0].g, stops[0].b);
+
+  for (uint8_t i = 1; i < key.stopCount; i++)
+  {
+    if (pos <= stops[i].pos)
+    {
+      const Stop &a = stops[i - 1];
+      const Stop &b = stops[i];
+      uint8_t span = b.pos - a.pos;
+      uint8_t frac = span ? (uint16_t)(pos - a.pos) * 255 / span : 255;
+      return blend(CRGB(a.r, a.g, a.b), CRGB(b.r, b.g, b.b), frac);
+    }
+  }
+  const Stop &last = stops[key.stopCount - 1];
+  return CRGB(last.r, last.g, last.b);
+}
+
+void TimelinePlayer::renderTrack(Track &track, uint32_t t, CRGB *leds, uint16_t count)
+{
+  advance(track, t);
+  if (!track.hasPrev)
+  {
+    fill_solid(leds, count, CRGB::Black);
+    return;
+  }
+
+  uint8_t progress = 0;
+  if (track.hasNext && track.next.timeMs > track.prev.timeMs)
+  {
+    uint32_t span = track.next.timeMs - track.prev.timeMs;
+    uint32_t elapsed = t > track.prev.timeMs ? t - track.prev.timeMs : 0;
+    progress = ease(track.prev.easing, elapsed >= span ? 255 : elapsed * 255 / span);
+  }
+
+  for (uint16_t i = 0; i < count; i++)
+  {
+    uint8_t pos = count > 1 ? (uint32_t)i * 255 / (count - 1) : 0;
+    CRGB from = sampleKey(track.prev, pos);
+    leds[i] = (progress && track.hasNext) ? blend(from, sampleKey(track.next, pos), progress) : from;
+  }
+}
+
+bool TimelinePlayer::render(uint32_t nowMs)
+{
+  if (!playing)
+    return false;
+
+  uint32_t t = nowMs - startMs;
+  if (t >= durationMs)
+  {
+    if (!looping)
+    {
+      stop();
+      return false;
+    }
+    startMs = nowMs;
+    t = 0;
+    for (uint8_t i = 0; i < TRACK_COUNT; i++)
+      rewindTrack(tracks[i]);
+  }
+
+  unsigned long begin = micros();
+  renderTrack(tracks[0], t, mainLeds, Config::MAIN_NUM_LEDS);
+  renderTrack(tracks[1], t, ringLeds, Config::RING_NUM_LEDS);
+  uint32_t cost = micros() - begin;
+
+  stats.frames++;
+  stats.decodeUsTotal += cost;
+  if (cost > stats.decodeUsMax)
+    stats.decodeUsMax = cost;
+  return true;
+}
+
+void TimelinePlayer::uploadBegin()
+{
+  stop();
+  uploadOk = mount();
+  if (uploadOk)
+  {
+    uploadFile = LittleFS.open(UPLOAD_PATH, "w");
+    uploadOk = (bool)uploadFile;
+  }
+}
+
+void TimelinePlayer::uploadWrite(const uint8_t *data, size_t len)
+{
+  if (uploadOk && uploadFile.write(data, len) != len)
+    uploadOk = false;
+}
+
+bool TimelinePlayer::uploadEnd()
+{
+  if (uploadFile)
+    uploadFile.close();
+  if (!uploadOk)
+    return false;
+
+  // 只校验文件头，关键帧在播放时逐帧校验
+  File check = LittleFS.open(UPLOAD_PATH, "r");
+  uint8_t raw[HEADER_SIZE];
+  bool valid = check && check.read(raw, HEADER_SIZE) == HEADER_SIZE &&
+               memcmp(raw, "LKT1", 4) == 0 && raw[4] == 1;
+  if (check)
+    check.close();
+
+  if (!valid)
+  {
+    LittleFS.remove(UPLOAD_PATH);
+    return false;
+  }
+  LittleFS.remove(TIMELINE_PATH);
+  return LittleFS.rename(UPLOAD_PATH, TIMELINE_PATH);
+}
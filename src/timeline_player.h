@@ -0,0 +1,128 @@
+#ifndef TIMELINE_PLAYER_H
+#define TIMELINE_PLAYER_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include "config.h"
+
+/*
+关键帧时间轴文件格式（小端，.lkt）：
+  文件头 28 字节
+    char[4]  magic = "LKT1"
+    uint8    version = 1
+    uint8    flags            bit0: 循环播放
+    uint16   reserved
+    uint32   durationMs       总时长
+    轨道描述 x2（0:主灯带 1:灯环）
+      uint32 offset           轨道第一帧在文件中的偏移
+      uint16 keyCount
+      uint16 reserved
+  每条轨道是按时间递增排列的关键帧：
+    uint32   timeMs
+    uint8    easing           TimelineEasing
+    uint8    stopCount        1..MAX_STOPS
+    stopCount x { uint8 pos(0-255沿灯带), uint8 r, uint8 g, uint8 b }
+*/
+
+enum TimelineEasing
+{
+  EASE_LINEAR,
+  EASE_IN,
+  EASE_OUT,
+  EASE_IN_OUT,
+  EASE_STEP,
+  EASE_SINE,
+  EASE_EXPO,
+  EASE_CIE,
+  EASE_COUNT
+};
+
+class TimelinePlayer
+{
+public:
+  static const uint8_t TRACK_COUNT = 2;
+  static const uint8_t MAX_STOPS = 8;
+
+  struct Stats
+  {
+    uint32_t frames;
+    uint32_t decodeUsTotal;   // 解码+渲染累计耗时
+    uint32_t decodeUsMax;
+    uint16_t bufferPeak;      // 环形缓冲区最高占用
+  };
+
+  TimelinePlayer();
+  void begin(CRGB *main, CRGB *ring);
+  bool hasTimeline();
+  bool start();
+  void stop();
+  bool render(uint32_t nowMs);   // 返回false表示播放结束
+  bool isPlaying() const;
+  const Stats &getStats() const;
+
+  // 上传处理：分块写入临时文件，结束时校验后替换
+  void uploadBegin();
+  void uploadWrite(const uint8_t *data, size_t len);
+  bool uploadEnd();
+
+private:
+  static const uint16_t BUFFER_SIZE = 256;   // 每条轨道的流缓冲
+  static const uint16_t REFILL_CHUNK = 64;
+
+  struct Stop
+  {
+    uint8_t pos;
+    uint8_t r, g, b;
+  };
+
+  struct Key
+  {
+    uint32_t timeMs;
+    uint8_t easing;
+    uint8_t stopCount;
+    Stop stops[MAX_STOPS];
+  };
+
+  // 从文件流式读取的环形缓冲
+  struct Track
+  {
+    File file;
+    uint32_t offset;
+    uint16_t keyCount;
+    uint16_t keysRead;
+    uint8_t buffer[BUFFER_SIZE];
+    uint16_t head;
+    uint16_t used;
+    Key prev;
+    Key next;
+    bool hasPrev;
+    bool hasNext;
+  };
+
+  CRGB *mainLeds;
+  CRGB *ringLeds;
+  bool mounted;
+  bool playing;
+  bool looping;
+  uint32_t durationMs;
+  uint32_t startMs;
+  File uploadFile;
+  bool uploadOk;
+  Track tracks[TRACK_COUNT];
+  Stats stats;
+
+  bool mount();
+  bool openTracks();
+  void rewindTrack(Track &track);
+  void refill(Track &track);
+  bool readBytes(Track &track, uint8_t *out, uint16_t len);
+  bool decodeKey(Track &track, Key &key);
+  void advance(Track &track, uint32_t t);
+  void renderTrack(Track &track, uint32_t t, CRGB *leds, uint16_t count);
+  static uint8_t ease(uint8_t easing, uint8_t progress);
+  static CRGB sampleKey(const Key &key, uint8_t pos);
+};
+
+extern TimelinePlayer timelinePlayer;
+
+#endif
@@ -0,0 +1,71 @@
+#include "timer_heap.h"
+
+TimerHeap::TimerHeap()
+    : count(0)
+{
+}
+
+void TimerHeap::clear()
+{
+    count = 0;
+}
+
+bool TimerHeap::earlier(const Timer &a, const Timer &b)
+{
+    return (int32_t)(a.dueMs - b.dueMs) < 0;
+}
+
+bool TimerHeap::push(uint32_t dueMs, uint8_t id)
+{
+    if (count >= CAPACITY)
+        return false;
+    Timer timer{dueMs, id};
+    uint8_t i = count++;
+    while (i > 0)
+    {
+        uint8_t parent = (i - 1) / 2;
+        if (!earlier(timer, heap[parent]))
+            break;
+        heap[i] = heap[parent];
+        i = parent;
+    }
+    heap[i] = timer;
+    return true;
+}
+
+void TimerHeap::pop()
+{
+    if (count == 0)
+        return;
+    Timer last = heap[--count];
+    uint8_t i = 0;
+    for (;;)
+    {
+        uint8_t child = i * 2 + 1;
+        if (child >= count)
+            break;
+        if (child + 1 < count && earlier(heap[child + 1], heap[child]))
+            child++;
+        if (!earlier(heap[child], last))
+            break;
+        heap[i] = heap[child];
+        i = child;
+    }
+    if (count > 0)
+        heap[i] = last;
+}
+
+bool TimerHeap::empty() const
+{
+    return count == 0;
+}
+
+uint8_t TimerHeap::size() const
+{
+    return count;
+}
+
+const TimerHeap::Timer &TimerHeap::top() const
+{
+    return heap[0];
+}
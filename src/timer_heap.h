@@ -0,0 +1,34 @@
+#ifndef TIMER_HEAP_H
+#define TIMER_HEAP_H
+
+#include <stdint.h>
+
+// 定时器最小堆：按到期时间（millis）排序，堆顶最早到期。不依赖Arduino头文件，主机端可直接编译
+// 所有到期时间都在当前时刻之后24小时内，用差值比较即可跨过millis回绕
+class TimerHeap
+{
+public:
+    struct Timer
+    {
+        uint32_t dueMs;
+        uint8_t id;              // 调用方自己的编号（日程里是表项下标）
+    };
+
+    static const uint8_t CAPACITY = 16;
+
+    TimerHeap();
+    void clear();
+    bool push(uint32_t dueMs, uint8_t id);       // 堆满时返回false
+    void pop();
+    bool empty() const;
+    uint8_t size() const;
+    const Timer &top() const;                    // 堆非空时才能调用
+
+private:
+    Timer heap[CAPACITY];
+    uint8_t count;
+
+    static bool earlier(const Timer &a, const Timer &b);
+};
+
+#endif
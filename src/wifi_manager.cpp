@@ -0,0 +1,121 @@
+#include "wifi_manager.h"
+
+WiFiManager wifiManager;
+
+WiFiManager::WiFiManager()
+    : linkState(LINK_IDLE),
+      stateSince(0),
+      lastBlink(0),
+      retryCount(0),
+      reconnectCount(0)
+{
+}
+
+void WiFiManager::begin()
+{
+  WiFi.mode(WIFI_STA);
+  // 自动重连交给本状态机处理，避免和驱动内部重连互相打架
+  WiFi.setAutoReconnect(false);
+
+  // 配置静态IP
+  if (!WiFi.config(Config::localIP(), Config::gateway(), Config::subnet()))
+  {
+    Serial.println("STA Failed to configure");
+  }
+
+  startConnect();
+}
+
+void WiFiManager::startConnect()
+{
+  Serial.println("正在连接WiFi...");
+  WiFi.begin(Config::wifiSSID(), Config::wifiPassword());
+  enterState(LINK_CONNECTING);
+}
+
+void WiFiManager::enterState(LinkState newState)
+{
+  linkState = newState;
+  stateSince = millis();
+}
+
+void WiFiManager::loop()
+{
+  unsigned long now = millis();
+  bool connected = (WiFi.status() == WL_CONNECTED);
+
+  switch (linkState)
+  {
+  case LINK_IDLE:
+    break;
+
+  case LINK_CONNECTING:
+    if (connected)
+    {
+      Serial.print("WiFi连接成功! IP地址: ");
+      Serial.println(WiFi.localIP());
+      digitalWrite(Config::BOARD_LED_PIN, HIGH);
+      retryCount = 0;
+      enterState(LINK_CONNECTED);
+    }
+    else if (now - stateSince >= Config::WIFI_CONNECT_TIMEOUT_MS)
+    {
+      Serial.println("WiFi连接超时，稍后重试（灯光继续离线运行）");
+      WiFi.disconnect();
+      digitalWrite(Config::BOARD_LED_PIN, LOW);
+      if (retryCount < 255)
+        retryCount++;
+      enterState(LINK_WAIT_RETRY);
+    }
+    else if (now - lastBlink >= 500)
+    {
+      // 连接中：板载LED闪烁
+      lastBlink = now;
+      digitalWrite(Config::BOARD_LED_PIN, !digitalRead(Config::BOARD_LED_PIN));
+    }
+    break;
+
+  case LINK_CONNECTED:
+    if (!connected)
+    {
+      Serial.println("WiFi连接断开，准备重连");
+      digitalWrite(Config::BOARD_LED_PIN, LOW);
+      reconnectCount++;
+      enterState(LINK_WAIT_RETRY);
+    }
+    break;
+
+  case LINK_WAIT_RETRY:
+    if (now - stateSince >= retryBackoffMs())
+    {
+      startConnect();
+    }
+    break;
+  }
+}
+
+// 线性退避，最长不超过WIFI_RETRY_MAX_MS
+unsigned long WiFiManager::retryBackoffMs() const
+{
+  unsigned long backoff = (unsigned long)Config::WIFI_RETRY_BASE_MS * (retryCount + 1);
+  return backoff > Config::WIFI_RETRY_MAX_MS ? Config::WIFI_RETRY_MAX_MS : backoff;
+}
+
+unsigned long WiFiManager::retryRemainingMs() const
+{
+  if (linkState != LINK_WAIT_RETRY)
+    return 0;
+  unsigned long waited = millis() - stateSince;
+  unsigned long backoff = retryBackoffMs();
+  return waited >= backoff ? 0 : backoff - waited;
+}
+
+bool WiFiManager::isConnected() const
+{
+  return linkState == LINK_CONNECTED;
+}
+
+uint32_t WiFiManager::getReconnectCount() const
+{
+  return reconnectCount;
+}
@@ -0,0 +1,43 @@
+#ifndef WIFI_MANAGER_H
+#define WIFI_MANAGER_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// WiFi连接状态机：在loop()中轮询推进，不阻塞灯光启动
+class WiFiManager
+{
+private:
+    enum LinkState
+    {
+        LINK_IDLE,
+        LINK_CONNECTING,
+        LINK_CONNECTED,
+        LINK_WAIT_RETRY
+    };
+
+    LinkState linkState;
+    unsigned long stateSince;    // 进入当前状态的时间
+    unsigned long lastBlink;     // 板载LED闪烁计时
+    uint8_t retryCount;          // 连续失败次数，用于退避
+    uint32_t reconnectCount;     // 累计重连次数
+
+    void startConnect();
+    void enterState(LinkState newState);
+    unsigned long retryBackoffMs() const;
+
+public:
+    // 构造函数
+    WiFiManager();
+
+    // 公共接口
+    void begin();
+    void loop();
+    bool isConnected() const;
+    uint32_t getReconnectCount() const;
+    unsigned long retryRemainingMs() const;   // 等待重连时距下次尝试的时间，其余状态为0
+};
+
+extern WiFiManager wifiManager;
+
+#endif
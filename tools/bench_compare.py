@@ -0,0 +1,51 @@
+#!/usr/bin/env python3
+"""对比两次 /bench 结果，标出变慢超过阈值的内核。
+
+用法:
+  python bench_compare.py <设备IP> > new.json        # 抓取一次结果
+  python bench_compare.py old.json new.json [阈值%]  # 对比，默认阈值10%
+存在超过阈值的回退时退出码为1，可用于提交前检查。
+"""
+import json
+import sys
+import urllib.request
+
+
+def load(source):
+    if source.endswith(".json"):
+        with open(source, encoding="utf-8") as f:
+            return json.load(f)
+    with urllib.request.urlopen("http://%s/bench" % source, timeout=10) as resp:
+        return json.loads(resp.read().decode("utf-8"))
+
+
+def main():
+    if len(sys.argv) == 2:
+        print(json.dumps(load(sys.argv[1]), ensure_ascii=False, indent=1))
+        return 0
+    if len(sys.argv) not in (3, 4):
+        print(__doc__)
+        return 2
+
+    old = {r["name"]: r for r in load(sys.argv[1])["results"]}
+    new = load(sys.argv[2])
+    threshold = float(sys.argv[3]) if len(sys.argv) == 4 else 10.0
+
+    regressions = 0
+    print("%-20s %10s %10s %8s" % ("kernel", "old_ns", "new_ns", "change"))
+    for r in new["results"]:
+        base = old.get(r["name"])
+        if base is None or base["avgNs"] == 0:
+            print("%-20s %10s %10d %8s" % (r["name"], "-", r["avgNs"], "new"))
+            continue
+        change = (r["avgNs"] - base["avgNs"]) * 100.0 / base["avgNs"]
+        flag = ""
+        if change > threshold:
+            flag = "  <-- 变慢"
+            regressions += 1
+        print("%-20s %10d %10d %+7.1f%%%s" % (r["name"], base["avgNs"], r["avgNs"], change, flag))
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
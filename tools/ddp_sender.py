@@ -0,0 +1,69 @@
+#!/usr/bin/env python3
+"""PC端DDP测试发送器：向设备推送彩虹帧并统计发送速率。
+
+用法: python ddp_sender.py <设备IP> [fps] [秒数]
+设备收到数据后自动切换到像素流模式，停止发送 2.5 秒后恢复原模式。
+"""
+import colorsys
+import socket
+import struct
+import sys
+import time
+
+DDP_PORT = 4048
+MAIN_NUM_LEDS = 60
+RING_NUM_LEDS = 16
+FLAG_VER1 = 0x40
+FLAG_PUSH = 0x01
+DATA_TYPE_RGB8 = 0x0B
+MAX_DATA = 1440  # 单包数据上限，帧较大时拆成多包，仅最后一包带PUSH
+
+
+def make_frame(phase):
+    pixels = bytearray()
+    total = MAIN_NUM_LEDS + RING_NUM_LEDS
+    for i in range(total):
+        r, g, b = colorsys.hsv_to_rgb(((i / total) + phase) % 1.0, 1.0, 1.0)
+        pixels += bytes((int(r * 255), int(g * 255), int(b * 255)))
+    return pixels
+
+
+def send_frame(sock, addr, seq, data):
+    offset = 0
+    while offset < len(data):
+        chunk = data[offset:offset + MAX_DATA]
+        last = offset + len(chunk) >= len(data)
+        flags = FLAG_VER1 | (FLAG_PUSH if last else 0)
+        header = struct.pack(">BBBBIH", flags, seq, DATA_TYPE_RGB8, 1, offset, len(chunk))
+        sock.sendto(header + chunk, addr)
+        offset += len(chunk)
+        seq = seq % 15 + 1
+    return seq
+
+
+def main():
+    if len(sys.argv) < 2:
+        print(__doc__)
+        sys.exit(1)
+    addr = (sys.argv[1], DDP_PORT)
+    fps = float(sys.argv[2]) if len(sys.argv) > 2 else 60.0
+    seconds = float(sys.argv[3]) if len(sys.argv) > 3 else 10.0
+
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    seq = 1
+    frames = 0
+    start = time.monotonic()
+    next_frame = start
+    while time.monotonic() - start < seconds:
+        seq = send_frame(sock, addr, seq, make_frame(frames / (fps * 4)))
+        frames += 1
+        next_frame += 1.0 / fps
+        delay = next_frame - time.monotonic()
+        if delay > 0:
+            time.sleep(delay)
+    elapsed = time.monotonic() - start
+    print("发送 %d 帧，%.1f 帧/秒" % (frames, frames / elapsed))
+
+
+if __name__ == "__main__":
+    main()
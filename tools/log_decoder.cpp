@@ -0,0 +1,133 @@
+// 主机端二进制日志解码器：把串口抓取的原始数据还原成文本
+// 编译: g++ -std=c++17 -I../src -o log_decoder log_decoder.cpp
+// 用法: ./log_decoder dump.bin   或   cat /dev/ttyUSB0 | ./log_decoder
+// 非日志帧的字节（开机信息等普通串口文本）原样输出
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "log_ids.h"
+#include "light_mode.h"
+
+static int32_t readI32(const uint8_t *p)
+{
+  uint32_t v = (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+  return (int32_t)v;
+}
+
+static void printRecord(uint32_t timestamp, uint16_t id, const int32_t *args)
+{
+  static const char *LEVEL_NAMES[] = {"D", "I", "W", "E"};
+  const BinlogMessage &msg = BINLOG_TABLE[id];
+  printf("[%10.3f] %s ", timestamp / 1000.0, LEVEL_NAMES[msg.level]);
+
+  int argIndex = 0;
+  for (const char *p = msg.format; *p; p++)
+  {
+    if (*p != '%' || p[1] == '\0')
+    {
+      putchar(*p);
+      continue;
+    }
+    p++;
+    int32_t value = argIndex < (int)msg.argc ? args[argIndex++] : 0;
+    switch (*p)
+    {
+    case 'd':
+      printf("%d", value);
+      break;
+    case 'u':
+      printf("%u", (uint32_t)value);
+      break;
+    case 'm':
+    {
+      printf("%s", (uint32_t)value < MODE_COUNT ? MODE_NAMES[value] : "?");
+      break;
+    }
+    default:
+      putchar('%');
+      putchar(*p);
+      break;
+    }
+  }
+  putchar('\n');
+}
+
+// 尝试在buf[pos]处解析一帧，成功返回帧长度，数据不足返回-1，不是合法帧返回0
+static long tryFrame(const std::vector<uint8_t> &buf, size_t pos)
+{
+  if (buf.size() - pos < BINLOG_HEADER_SIZE)
+    return -1;
+  const uint8_t *p = &buf[pos];
+  uint8_t checksum = 0;
+  for (int i = 0; i < 9; i++)
+    checksum ^= p[i];
+  uint16_t id = (uint16_t)(p[6] | (p[7] << 8));
+  uint8_t argc = p[8];
+  if (checksum != p[9] || id >= LOGID_COUNT || argc != BINLOG_TABLE[id].argc)
+    return 0;
+  size_t length = BINLOG_HEADER_SIZE + argc * 4;
+  if (buf.size() - pos < length)
+    return -1;
+
+  int32_t args[BINLOG_MAX_ARGS] = {0};
+  for (int i = 0; i < argc; i++)
+    args[i] = readI32(p + BINLOG_HEADER_SIZE + i * 4);
+  uint32_t timestamp = (uint32_t)readI32(p + 2);
+  printRecord(timestamp, id, args);
+  return (long)length;
+}
+
+int main(int argc, char **argv)
+{
+  FILE *in = stdin;
+  if (argc > 1)
+  {
+    in = fopen(argv[1], "rb");
+    if (!in)
+    {
+      perror(argv[1]);
+      return 1;
+    }
+  }
+
+  std::vector<uint8_t> buf;
+  uint8_t chunk[4096];
+  size_t n;
+  bool eof = false;
+  while (!eof)
+  {
+    n = fread(chunk, 1, sizeof(chunk), in);
+    if (n == 0)
+      eof = true;
+    buf.insert(buf.end(), chunk, chunk + n);
+
+    size_t pos = 0;
+    while (pos < buf.size())
+    {
+      if (buf[pos] == BINLOG_SYNC0 && pos + 1 < buf.size() && buf[pos + 1] == BINLOG_SYNC1)
+      {
+        long length = tryFrame(buf, pos);
+        if (length > 0)
+        {
+          pos += length;
+          continue;
+        }
+        if (length < 0 && !eof)
+          break; // 等待更多数据
+      }
+      else if (buf[pos] == BINLOG_SYNC0 && pos + 1 == buf.size() && !eof)
+      {
+        break;
+      }
+      putchar(buf[pos]);
+      pos++;
+    }
+    buf.erase(buf.begin(), buf.begin() + pos);
+    fflush(stdout);
+  }
+
+  if (in != stdin)
+    fclose(in);
+  return 0;
+}
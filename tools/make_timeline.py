@@ -0,0 +1,68 @@
+#!/usr/bin/env python3
+"""把JSON描述的关键帧时间轴打包成设备使用的 .lkt 二进制文件。
+
+JSON 格式:
+{
+  "duration": 10000,          // 总时长(ms)
+  "loop": true,
+  "main": [ {"t": 0, "ease": "in_out", "stops": [[0, "#ff0000"], [255, "#0000ff"]]}, ... ],
+  "ring": [ ... ]
+}
+ease 可选: linear / in / out / in_out / step / sine / expo / cie
+
+用法: python make_timeline.py show.json show.lkt
+然后在网页上传，或 curl -F "timeline=@show.lkt" http://<ip>/timeline
+"""
+import json
+import struct
+import sys
+
+EASINGS = {"linear": 0, "in": 1, "out": 2, "in_out": 3, "step": 4, "sine": 5, "expo": 6, "cie": 7}
+MAX_STOPS = 8
+HEADER_SIZE = 28
+
+
+def pack_track(keys):
+    out = bytearray()
+    last = -1
+    for key in keys:
+        t = int(key["t"])
+        if t < last:
+            raise ValueError("关键帧时间必须递增: %d" % t)
+        last = t
+        stops = key["stops"]
+        if not 1 <= len(stops) <= MAX_STOPS:
+            raise ValueError("每帧色标数量须在1..%d之间" % MAX_STOPS)
+        out += struct.pack("<IBB", t, EASINGS[key.get("ease", "linear")], len(stops))
+        for pos, color in sorted(stops, key=lambda s: s[0]):
+            rgb = int(color.lstrip("#"), 16)
+            out += struct.pack("<BBBB", pos, (rgb >> 16) & 0xFF, (rgb >> 8) & 0xFF, rgb & 0xFF)
+    return out
+
+
+def main():
+    if len(sys.argv) != 3:
+        print(__doc__)
+        sys.exit(1)
+    with open(sys.argv[1], encoding="utf-8") as f:
+        show = json.load(f)
+
+    tracks = [pack_track(show.get("main", [])), pack_track(show.get("ring", []))]
+    key_counts = [len(show.get("main", [])), len(show.get("ring", []))]
+
+    header = bytearray(b"LKT1")
+    header += struct.pack("<BBHI", 1, 1 if show.get("loop") else 0, 0, int(show["duration"]))
+    offset = HEADER_SIZE
+    for data, count in zip(tracks, key_counts):
+        header += struct.pack("<IHH", offset, count, 0)
+        offset += len(data)
+
+    with open(sys.argv[2], "wb") as f:
+        f.write(header)
+        for data in tracks:
+            f.write(data)
+    print("写入 %s: %d 字节" % (sys.argv[2], offset))
+
+
+if __name__ == "__main__":
+    main()
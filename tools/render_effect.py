@@ -0,0 +1,47 @@
+#!/usr/bin/env python3
+"""在设备上离线渲染某个模式并下载帧序列，打印渲染吞吐量。
+
+用法:
+  python render_effect.py <设备IP> <模式> [秒数] [帧率] [输出文件]
+模式为 breathe / rainbow / starlight / segments / layers，默认10秒、50帧/秒。
+输出文件以 .ppm 结尾时保存为图像（每行一帧，主灯带在左、灯环在右），
+否则保存为连续的原始RGB帧。安装了Pillow时 .png 也可以，由PPM转换。
+"""
+import sys
+import time
+import urllib.request
+
+
+def main():
+    if len(sys.argv) < 3:
+        print(__doc__)
+        return 2
+    host, mode = sys.argv[1], sys.argv[2]
+    seconds = int(sys.argv[3]) if len(sys.argv) > 3 else 10
+    fps = int(sys.argv[4]) if len(sys.argv) > 4 else 50
+    out = sys.argv[5] if len(sys.argv) > 5 else "%s.ppm" % mode
+    fmt = "raw" if out.endswith((".rgb", ".raw", ".bin")) else "ppm"
+
+    url = "http://%s/render?mode=%s&seconds=%d&fps=%d&format=%s" % (host, mode, seconds, fps, fmt)
+    start = time.perf_counter()
+    with urllib.request.urlopen(url, timeout=120) as resp:
+        data = resp.read()
+    elapsed = time.perf_counter() - start
+
+    if out.endswith(".png"):
+        import io
+        from PIL import Image
+        Image.open(io.BytesIO(data)).save(out)
+    else:
+        with open(out, "wb") as f:
+            f.write(data)
+
+    with urllib.request.urlopen("http://%s/render" % host, timeout=5) as resp:
+        stats = resp.read().decode("utf-8")
+    print("%s: %d 帧 -> %s，下载 %.1fs" % (mode, seconds * fps, out, elapsed))
+    print("设备端渲染统计: %s" % stats)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
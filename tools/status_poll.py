@@ -0,0 +1,82 @@
+#!/usr/bin/env python3
+"""模拟网页轮询 /status，对比带 If-None-Match（304）和不带（200）时的延迟。
+
+用法:
+  python status_poll.py <设备IP> [次数] [并发数]   # 默认200次、4个并发
+结束后读取 /metrics 中的 led_status_* 计数，确认状态未变化时没有重建缓存。
+"""
+import statistics
+import sys
+import threading
+import time
+import urllib.error
+import urllib.request
+
+
+def fetch(host, etag=None):
+    req = urllib.request.Request("http://%s/status" % host)
+    if etag:
+        req.add_header("If-None-Match", etag)
+    start = time.perf_counter()
+    try:
+        with urllib.request.urlopen(req, timeout=5) as resp:
+            resp.read()
+            code, tag = resp.status, resp.headers.get("ETag")
+    except urllib.error.HTTPError as e:
+        code, tag = e.code, e.headers.get("ETag")
+    return code, tag, (time.perf_counter() - start) * 1000.0
+
+
+def poll(host, count, workers, etag):
+    latencies = []
+    codes = {}
+    lock = threading.Lock()
+
+    def worker(n):
+        for _ in range(n):
+            code, _, ms = fetch(host, etag)
+            with lock:
+                latencies.append(ms)
+                codes[code] = codes.get(code, 0) + 1
+
+    threads = [threading.Thread(target=worker, args=(count // workers,)) for _ in range(workers)]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    return latencies, codes
+
+
+def report(label, latencies, codes):
+    latencies.sort()
+    p99 = latencies[int(len(latencies) * 0.99) - 1]
+    print("%-6s codes=%s  median=%.1fms  p99=%.1fms" % (label, codes, statistics.median(latencies), p99))
+
+
+def status_counters(host):
+    with urllib.request.urlopen("http://%s/metrics" % host, timeout=5) as resp:
+        text = resp.read().decode("utf-8")
+    return {line.split()[0]: int(line.split()[1]) for line in text.splitlines()
+            if line.startswith("led_status_")}
+
+
+def main():
+    if len(sys.argv) < 2:
+        print(__doc__)
+        return 2
+    host = sys.argv[1]
+    count = int(sys.argv[2]) if len(sys.argv) > 2 else 200
+    workers = int(sys.argv[3]) if len(sys.argv) > 3 else 4
+
+    _, etag, _ = fetch(host)
+    before = status_counters(host)
+    report("200", *poll(host, count, workers, None))
+    report("304", *poll(host, count, workers, etag))
+    after = status_counters(host)
+    for key in sorted(after):
+        print("%s +%d" % (key, after[key] - before.get(key, 0)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,50 @@
+#!/usr/bin/env python3
+"""启动设备上的帧抖动压力测试，等待结束后打印每个效果的帧间隔分布。
+
+用法:
+  python stress_run.py <设备IP> [客户端数] [每个效果秒数] [预算us]   # 默认4个客户端、5秒、4000us
+模拟客户端运行在设备的核心0上，经本机回环请求 /control 和 /，不占用本机网络。
+任一效果的p99帧间隔超出目标周期加预算时退出码为1，可直接用于CI或回归对比。
+"""
+import json
+import sys
+import time
+import urllib.request
+
+
+def get(host, path):
+    with urllib.request.urlopen("http://%s%s" % (host, path), timeout=10) as resp:
+        return json.loads(resp.read().decode("utf-8"))
+
+
+def main():
+    if len(sys.argv) < 2:
+        print(__doc__)
+        return 2
+    host = sys.argv[1]
+    clients = int(sys.argv[2]) if len(sys.argv) > 2 else 4
+    seconds = int(sys.argv[3]) if len(sys.argv) > 3 else 5
+    budget = int(sys.argv[4]) if len(sys.argv) > 4 else 4000
+
+    get(host, "/stress?clients=%d&seconds=%d&budget=%d" % (clients, seconds, budget))
+    while True:
+        time.sleep(1)
+        try:
+            report = get(host, "/stress")
+        except OSError:
+            continue    # 测试期间设备繁忙，偶尔超时
+        if report["state"] == "done":
+            break
+        print("\r%ds 请求%d 失败%d" % (report["elapsedS"], report["requests"], report["failures"]), end="", flush=True)
+
+    print("\n请求 %d，失败 %d，人体边沿 %d，预算 %dus" %
+          (report["requests"], report["failures"], report["pirEdges"], report["budgetUs"]))
+    print("%-12s %7s %8s %8s %8s %8s  %s" % ("阶段", "帧数", "目标us", "p50us", "p99us", "maxus", "结果"))
+    for e in report["effects"]:
+        print("%-12s %7d %8d %8d %8d %8d  %s" % (e["phase"], e["frames"], e["targetUs"], e["p50Us"],
+                                                e["p99Us"], e["maxUs"], "通过" if e["pass"] else "超出预算"))
+    return 0 if report["pass"] else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())